@@ -1,63 +1,78 @@
-#pragma once
-#include "D3D12AppBase.h"
-#include "DirectXMath.h"
-#include "Camera.h"
-
-#include <array>
-#include <unordered_map>
-
-#include "Model.h"
-
-class StreamOutputApp : public D3D12AppBase {
-public:
-  StreamOutputApp();
-
-  virtual void Prepare();
-  virtual void Cleanup();
-  virtual void Render();
-
-  virtual void OnMouseButtonDown(UINT msg);
-  virtual void OnMouseButtonUp(UINT msg);
-  virtual void OnMouseMove(UINT msg, int dx, int dy);
-
-  struct ShaderParameters
-  {
-    DirectX::XMFLOAT4X4 view;
-    DirectX::XMFLOAT4X4 proj;
-    DirectX::XMFLOAT4 lightDir;
-  };
-  ShaderParameters m_scenePatameters;
-
-  struct ShaderDrawMeshParameter
-  {
-    DirectX::XMUINT4  offset;
-    DirectX::XMMATRIX bones[512];
-  };
-private:
-  void CreateRootSignatures();
-
-  void PreparePipeline();
-
-  void RenderHUD();
-private:
-  Camera m_camera;
-
-  ComPtr<ID3D12RootSignature> m_rootSignature, m_rootSignatureGS;
-  std::vector<Buffer> m_sceneParameterCB;
-
-  using PipelineState = ComPtr<ID3D12PipelineState>;
-  std::unordered_map<std::string, PipelineState> m_pipelines;
-
-  enum DrawMode
-  {
-    DrawMode_GS = 0,
-    DrawMode_VS,
-  };
-  DrawMode m_mode = DrawMode_GS;
-
-  model::ModelAsset m_skinActor;
-
-  const std::string PSO_VS_OUT = "VS_OUT";
-  const std::string PSO_GS_OUT = "GS_OUT";
-  const std::string PSO_SO_DRAW = "SO_DRAW";
+#pragma once
+#include "D3D12AppBase.h"
+#include "DirectXMath.h"
+#include "Camera.h"
+
+#include <array>
+#include <unordered_map>
+
+#include "Model.h"
+
+class StreamOutputApp : public D3D12AppBase {
+public:
+  StreamOutputApp();
+
+  virtual void Prepare();
+  virtual void Cleanup();
+  virtual void Render();
+
+  virtual void OnMouseButtonDown(UINT msg);
+  virtual void OnMouseButtonUp(UINT msg);
+  virtual void OnMouseMove(UINT msg, int dx, int dy);
+
+  struct ShaderParameters
+  {
+    DirectX::XMFLOAT4X4 view;
+    DirectX::XMFLOAT4X4 proj;
+    DirectX::XMFLOAT4 lightDir;
+  };
+  ShaderParameters m_scenePatameters;
+
+  struct ShaderDrawMeshParameter
+  {
+    DirectX::XMUINT4  offset;
+    DirectX::XMFLOAT4 positionScale;  // 量子化頂点の復元用.
+    DirectX::XMFLOAT4 positionBias;
+    DirectX::XMUINT4  boneRemap[128];  // バッチ内のボーン番号 -> パレット番号 (4 つずつ詰める).
+  };
+private:
+  void CreateRootSignatures();
+
+  void PreparePipeline();
+
+  void RenderHUD();
+private:
+  Camera m_camera;
+
+  ComPtr<ID3D12RootSignature> m_rootSignature, m_rootSignatureGS;
+  std::vector<Buffer> m_sceneParameterCB;
+
+  using PipelineState = ComPtr<ID3D12PipelineState>;
+  std::unordered_map<std::string, PipelineState> m_pipelines;
+
+  enum DrawMode
+  {
+    DrawMode_GS = 0,
+    DrawMode_VS,
+  };
+  DrawMode m_mode = DrawMode_GS;
+
+  model::ModelAsset m_skinActor;
+  // 比較/計測用の CPU スキニング.
+  bool m_useCpuSkinning = false;
+  float m_cpuSkinningTimeMs = 0.0f;
+  std::vector<DirectX::XMFLOAT3> m_cpuSkinnedPositions, m_cpuSkinnedNormals;
+
+  animation::SampleCursor m_animationCursor;
+  float m_animationTime = 0.0f;
+
+  // 画面上の大きさに応じた LOD 選択.
+  bool m_useLod = true;
+  float m_lodMaxErrorPx = 1.0f;
+  std::vector<model::LodLevel> m_drawLods;
+  UINT m_drawTriangleCount = 0;
+
+  const std::string PSO_VS_OUT = "VS_OUT";
+  const std::string PSO_GS_OUT = "GS_OUT";
+  const std::string PSO_SO_DRAW = "SO_DRAW";
 };
\ No newline at end of file
@@ -1,73 +1,114 @@
-struct VSInput
-{
-  float4 Position : POSITION;
-  float3 Normal : NORMAL;
-  float2 UV0 : TEXCOORD0;
-  uint4  BlendIndices : BLENDINDICES;
-  float4 BlendWeights : BLENDWEIGHTS;
-};
-
-struct GSOutput {
-  float4 Position : POSITION;
-  float3 Normal : NORMAL;
-  float2 UV0 : TEXCOORD0;
-};
-
-
-cbuffer SceneParameter : register(b0)
-{
-  float4x4 view;
-  float4x4 proj;
-  float4   lightdir;
-}
-cbuffer DrawBatchParameter : register(b1)
-{
-  uint4 offsetInfo; // x: x[X_CfbNX.
-  float4x4 boneMatrices[512];
-}
-
-
-float4 TransformPosition(VSInput In)
-{
-  float4 pos = 0;
-  float4 inPosition = In.Position;
-  uint indices[4] = (uint[4])In.BlendIndices;
-  float weights[4] = (float[4])In.BlendWeights;
-
-  for (int i = 0; i < 4; ++i)
-  {
-    float4x4 mtx = boneMatrices[indices[i]];
-    float w = weights[i];
-    pos += mul(inPosition, mtx) * w;
-  }
-  pos.w = 1;
-  return pos;
-}
-
-float3 TransformNormal(VSInput In)
-{
-  float3 nrm = 0;
-  float3 inNormal = In.Normal;
-  uint indices[4] = (uint[4])In.BlendIndices;
-  float weights[4] = (float[4])In.BlendWeights;
-
-  for (int i = 0; i < 4; ++i)
-  {
-    float4x4 mtx = boneMatrices[indices[i]];
-    float w = weights[i];
-    nrm += mul(inNormal, (float3x3)mtx) * w;
-  }
-  return normalize(nrm);
-}
-
-// XLjOό`KpăXg[AEgo.
-GSOutput mainVS(VSInput In)
-{
-  GSOutput result = (GSOutput)0;
-
-  result.Position = TransformPosition(In);
-  result.Normal = TransformNormal(In);
-  result.UV0 = In.UV0;
-
-  return result;
-}
+struct VSInput
+{
+  float4 Position : POSITION;
+#if USE_QUANTIZED_VERTEX
+  float2 Normal : NORMAL;   // 八面体エンコード.
+#else
+  float3 Normal : NORMAL;
+#endif
+  float2 UV0 : TEXCOORD0;
+  uint4  BlendIndices : BLENDINDICES;
+  float4 BlendWeights : BLENDWEIGHTS;
+};
+
+struct GSOutput {
+  float4 Position : POSITION;
+  float3 Normal : NORMAL;
+  float2 UV0 : TEXCOORD0;
+};
+
+
+cbuffer SceneParameter : register(b0)
+{
+  float4x4 view;
+  float4x4 proj;
+  float4   lightdir;
+}
+cbuffer DrawBatchParameter : register(b1)
+{
+  uint4 offsetInfo; // x: ベース頂点インデックス.
+  float4 positionScale; // 量子化頂点の復元用.
+  float4 positionBias;
+  uint4 boneRemap[128]; // バッチ内のボーン番号 -> パレット番号 (4 つずつ詰めて格納).
+}
+cbuffer BonePalette : register(b2)
+{
+  float4x4 boneMatrices[1024];
+}
+
+float4x4 GetBoneMatrix(uint boneIndex)
+{
+  return boneMatrices[boneRemap[boneIndex >> 2][boneIndex & 3]];
+}
+
+float4 DecodePosition(VSInput In)
+{
+#if USE_QUANTIZED_VERTEX
+  return float4(In.Position.xyz * positionScale.xyz + positionBias.xyz, 1);
+#else
+  return In.Position;
+#endif
+}
+
+float3 DecodeOctahedral(float2 e)
+{
+  float3 n = float3(e.xy, 1 - abs(e.x) - abs(e.y));
+  float t = saturate(-n.z);
+  n.xy += n.xy >= 0 ? -t : t;
+  return normalize(n);
+}
+
+float3 DecodeNormal(VSInput In)
+{
+#if USE_QUANTIZED_VERTEX
+  return DecodeOctahedral(In.Normal);
+#else
+  return In.Normal;
+#endif
+}
+
+
+float4 TransformPosition(VSInput In)
+{
+  float4 pos = 0;
+  float4 inPosition = DecodePosition(In);
+  uint indices[4] = (uint[4])In.BlendIndices;
+  float weights[4] = (float[4])In.BlendWeights;
+
+  for (int i = 0; i < 4; ++i)
+  {
+    float4x4 mtx = GetBoneMatrix(indices[i]);
+    float w = weights[i];
+    pos += mul(inPosition, mtx) * w;
+  }
+  pos.w = 1;
+  return pos;
+}
+
+float3 TransformNormal(VSInput In)
+{
+  float3 nrm = 0;
+  float3 inNormal = DecodeNormal(In);
+  uint indices[4] = (uint[4])In.BlendIndices;
+  float weights[4] = (float[4])In.BlendWeights;
+
+  for (int i = 0; i < 4; ++i)
+  {
+    float4x4 mtx = GetBoneMatrix(indices[i]);
+    float w = weights[i];
+    nrm += mul(inNormal, (float3x3)mtx) * w;
+  }
+  return normalize(nrm);
+}
+
+// スキニング変形を適用してストリームアウト出力.
+GSOutput mainVS(VSInput In)
+{
+  GSOutput result = (GSOutput)0;
+
+  result.Position = TransformPosition(In);
+  result.Normal = TransformNormal(In);
+  result.UV0 = In.UV0;
+
+  return result;
+}
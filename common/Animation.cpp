@@ -0,0 +1,383 @@
+#include "Animation.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+using namespace DirectX;
+
+namespace {
+  const float TimeScale = 65535.0f;
+  const float SmallestThreeRange = 0.70710678f;  // 最大成分以外の絶対値は 1/sqrt(2) 以下.
+  const uint32_t SmallestThreeMax = 0x7fff;
+
+  // times[0, count) の中で time を挟むキーを探す. key は前回の結果.
+  template<class T>
+  uint32_t FindKey(const T* times, uint32_t count, float time, uint32_t key, bool rewind) {
+    if (count <= 1) {
+      return 0;
+    }
+    if (rewind || key >= count) {
+      auto itr = std::upper_bound(times, times + count, time, [](float t, T v) { return t < float(v); });
+      return itr == times ? 0 : uint32_t(itr - times - 1);
+    }
+    while (key + 1 < count && float(times[key + 1]) <= time) {
+      ++key;
+    }
+    return key;
+  }
+
+  template<class T>
+  float GetBlendRate(const T* times, uint32_t count, uint32_t key, float time) {
+    if (key + 1 >= count) {
+      return 0.0f;
+    }
+    float span = float(times[key + 1]) - float(times[key]);
+    if (span <= 0.0f) {
+      return 0.0f;
+    }
+    return std::clamp((time - float(times[key])) / span, 0.0f, 1.0f);
+  }
+
+  float WrapTime(float time, float duration, bool loop) {
+    if (loop && duration > 0.0f) {
+      time = std::fmod(time, duration);
+      if (time < 0.0f) {
+        time += duration;
+      }
+      return time;
+    }
+    return std::clamp(time, 0.0f, duration);
+  }
+
+  // ---- 量子化 ----
+  uint16_t QuantizeUNorm16(float v) {
+    return uint16_t(std::clamp(v, 0.0f, 1.0f) * 65535.0f + 0.5f);
+  }
+
+  XMVECTOR DecodeUNorm16(const uint16_t* v, const XMFLOAT3& minValue, const XMFLOAT3& extent) {
+    auto n = XMVectorSet(float(v[0]), float(v[1]), float(v[2]), 0.0f) * (1.0f / 65535.0f);
+    return XMVectorMultiplyAdd(n, XMLoadFloat3(&extent), XMLoadFloat3(&minValue));
+  }
+
+  // 最大成分の番号 2bit と残り 3 成分の 15bit ずつを 48bit に詰める.
+  void EncodeSmallestThree(FXMVECTOR quaternion, uint16_t* out) {
+    XMFLOAT4 q;
+    XMStoreFloat4(&q, XMQuaternionNormalize(quaternion));
+    float c[4] = { q.x, q.y, q.z, q.w };
+    uint32_t largest = 0;
+    for (uint32_t i = 1; i < 4; ++i) {
+      if (std::abs(c[i]) > std::abs(c[largest])) {
+        largest = i;
+      }
+    }
+    // q と -q は同じ回転なので, 最大成分が正になる方を使う.
+    float sign = c[largest] < 0.0f ? -1.0f : 1.0f;
+    uint64_t bits = uint64_t(largest) << 45;
+    for (uint32_t i = 0, shift = 0; i < 4; ++i) {
+      if (i == largest) {
+        continue;
+      }
+      float n = (c[i] * sign + SmallestThreeRange) / (2.0f * SmallestThreeRange);
+      auto value = uint64_t(std::clamp(n, 0.0f, 1.0f) * SmallestThreeMax + 0.5f);
+      bits |= value << shift;
+      shift += 15;
+    }
+    out[0] = uint16_t(bits);
+    out[1] = uint16_t(bits >> 16);
+    out[2] = uint16_t(bits >> 32);
+  }
+
+  XMVECTOR DecodeSmallestThree(const uint16_t* v) {
+    uint64_t bits = uint64_t(v[0]) | (uint64_t(v[1]) << 16) | (uint64_t(v[2]) << 32);
+    auto abc = XMVectorSet(
+      float(bits & SmallestThreeMax),
+      float((bits >> 15) & SmallestThreeMax),
+      float((bits >> 30) & SmallestThreeMax), 0.0f);
+    abc = XMVectorMultiplyAdd(abc,
+      XMVectorReplicate(2.0f * SmallestThreeRange / SmallestThreeMax),
+      XMVectorReplicate(-SmallestThreeRange));
+    abc = XMVectorSetW(abc, 0.0f);
+    auto w = XMVectorSqrt(XMVectorMax(XMVectorReplicate(1.0f) - XMVector3Dot(abc, abc), XMVectorZero()));
+    switch (uint32_t(bits >> 45) & 3) {
+    case 0: return XMVectorPermute<XM_PERMUTE_1X, XM_PERMUTE_0X, XM_PERMUTE_0Y, XM_PERMUTE_0Z>(abc, w);
+    case 1: return XMVectorPermute<XM_PERMUTE_0X, XM_PERMUTE_1X, XM_PERMUTE_0Y, XM_PERMUTE_0Z>(abc, w);
+    case 2: return XMVectorPermute<XM_PERMUTE_0X, XM_PERMUTE_0Y, XM_PERMUTE_1X, XM_PERMUTE_0Z>(abc, w);
+    default: return XMVectorPermute<XM_PERMUTE_0X, XM_PERMUTE_0Y, XM_PERMUTE_0Z, XM_PERMUTE_1X>(abc, w);
+    }
+  }
+
+  // ---- キーの間引き ----
+  // 先頭と末尾は必ず残し, 間のキーは前後の残したキーからの補間で tolerance 以内に収まるなら捨てる.
+  template<class Error>
+  std::vector<uint32_t> ReduceKeys(const float* times, uint32_t count, Error error) {
+    std::vector<uint32_t> kept;
+    if (count == 0) {
+      return kept;
+    }
+    kept.push_back(0);
+    uint32_t anchor = 0;
+    for (uint32_t end = 2; end < count; ++end) {
+      bool ok = true;
+      for (uint32_t k = anchor + 1; k < end && ok; ++k) {
+        float span = times[end] - times[anchor];
+        float rate = span > 0.0f ? (times[k] - times[anchor]) / span : 0.0f;
+        ok = error(anchor, end, k, rate);
+      }
+      if (!ok) {
+        anchor = end - 1;
+        kept.push_back(anchor);
+      }
+    }
+    if (count > 1) {
+      kept.push_back(count - 1);
+    }
+    // 全キーが同じ値なら 1 つで足りる.
+    if (kept.size() == 2 && error(0, count - 1, count - 1, 0.0f)) {
+      kept.pop_back();
+    }
+    return kept;
+  }
+
+  void ApplyPose(model::Skeleton& skeleton, int node, uint32_t positionCount, uint32_t rotationCount, uint32_t scaleCount,
+    XMVECTOR translation, XMVECTOR rotation, XMVECTOR scale) {
+    // キーを持たない成分はバインドポーズの値を使う.
+    if (positionCount == 0 || rotationCount == 0 || scaleCount == 0) {
+      XMVECTOR bindScale, bindRotation, bindTranslation;
+      XMMatrixDecompose(&bindScale, &bindRotation, &bindTranslation, skeleton.GetLocalTransform(node));
+      translation = positionCount ? translation : bindTranslation;
+      rotation = rotationCount ? rotation : bindRotation;
+      scale = scaleCount ? scale : bindScale;
+    }
+    auto mtx = XMMatrixAffineTransformation(scale, XMVectorZero(), rotation, translation);
+    skeleton.SetLocalTransform(node, mtx);
+  }
+}
+
+namespace animation {
+  void SampleCursor::Reset(const void* clip, size_t trackCount) {
+    m_keys.assign(trackCount * 3, 0);
+    m_lastTime = 0.0f;
+    m_clip = clip;
+  }
+
+  size_t GetMemorySize(const AnimationClip& clip) {
+    return sizeof(Track) * clip.tracks.size()
+      + sizeof(float) * (clip.positionTimes.size() + clip.rotationTimes.size() + clip.scaleTimes.size())
+      + sizeof(XMFLOAT3) * (clip.positionValues.size() + clip.scaleValues.size())
+      + sizeof(XMFLOAT4) * clip.rotationValues.size();
+  }
+
+  size_t GetMemorySize(const CompressedClip& clip) {
+    return sizeof(CompressedTrack) * clip.tracks.size()
+      + sizeof(uint16_t) * (clip.positionTimes.size() + clip.rotationTimes.size() + clip.scaleTimes.size())
+      + sizeof(uint16_t) * (clip.positionValues.size() + clip.rotationValues.size() + clip.scaleValues.size());
+  }
+
+  void SampleClip(const AnimationClip& clip, float time, SampleCursor& cursor, model::Skeleton& skeleton, bool loop) {
+    if (cursor.m_clip != &clip || cursor.m_keys.size() != clip.tracks.size() * 3) {
+      cursor.Reset(&clip, clip.tracks.size());
+    }
+    time = WrapTime(time, clip.duration, loop);
+    // 時刻が戻った場合だけ二分探索でやり直す.
+    bool rewind = time < cursor.m_lastTime;
+    cursor.m_lastTime = time;
+
+    for (size_t i = 0; i < clip.tracks.size(); ++i) {
+      const auto& track = clip.tracks[i];
+      auto* keys = cursor.m_keys.data() + i * 3;
+
+      XMVECTOR translation = XMVectorZero(), rotation = XMQuaternionIdentity(), scale = XMVectorReplicate(1.0f);
+      if (track.positionCount > 0) {
+        const auto* times = clip.positionTimes.data() + track.positionOffset;
+        const auto* values = clip.positionValues.data() + track.positionOffset;
+        auto k = keys[0] = FindKey(times, track.positionCount, time, keys[0], rewind);
+        auto rate = GetBlendRate(times, track.positionCount, k, time);
+        auto k1 = std::min(k + 1, track.positionCount - 1);
+        translation = XMVectorLerp(XMLoadFloat3(&values[k]), XMLoadFloat3(&values[k1]), rate);
+      }
+      if (track.rotationCount > 0) {
+        const auto* times = clip.rotationTimes.data() + track.rotationOffset;
+        const auto* values = clip.rotationValues.data() + track.rotationOffset;
+        auto k = keys[1] = FindKey(times, track.rotationCount, time, keys[1], rewind);
+        auto rate = GetBlendRate(times, track.rotationCount, k, time);
+        auto k1 = std::min(k + 1, track.rotationCount - 1);
+        rotation = XMQuaternionSlerp(XMLoadFloat4(&values[k]), XMLoadFloat4(&values[k1]), rate);
+      }
+      if (track.scaleCount > 0) {
+        const auto* times = clip.scaleTimes.data() + track.scaleOffset;
+        const auto* values = clip.scaleValues.data() + track.scaleOffset;
+        auto k = keys[2] = FindKey(times, track.scaleCount, time, keys[2], rewind);
+        auto rate = GetBlendRate(times, track.scaleCount, k, time);
+        auto k1 = std::min(k + 1, track.scaleCount - 1);
+        scale = XMVectorLerp(XMLoadFloat3(&values[k]), XMLoadFloat3(&values[k1]), rate);
+      }
+      ApplyPose(skeleton, track.node, track.positionCount, track.rotationCount, track.scaleCount, translation, rotation, scale);
+    }
+  }
+
+  void SampleClip(const CompressedClip& clip, float time, SampleCursor& cursor, model::Skeleton& skeleton, bool loop) {
+    if (cursor.m_clip != &clip || cursor.m_keys.size() != clip.tracks.size() * 3) {
+      cursor.Reset(&clip, clip.tracks.size());
+    }
+    time = WrapTime(time, clip.duration, loop);
+    bool rewind = time < cursor.m_lastTime;
+    cursor.m_lastTime = time;
+    // キーの時刻は duration を 65535 とした整数.
+    float keyTime = clip.duration > 0.0f ? time / clip.duration * TimeScale : 0.0f;
+
+    for (size_t i = 0; i < clip.tracks.size(); ++i) {
+      const auto& track = clip.tracks[i];
+      auto* keys = cursor.m_keys.data() + i * 3;
+
+      XMVECTOR translation = XMVectorZero(), rotation = XMQuaternionIdentity(), scale = XMVectorReplicate(1.0f);
+      if (track.positionCount > 0) {
+        const auto* times = clip.positionTimes.data() + track.positionOffset;
+        const auto* values = clip.positionValues.data() + size_t(track.positionOffset) * 3;
+        auto k = keys[0] = FindKey(times, track.positionCount, keyTime, keys[0], rewind);
+        auto rate = GetBlendRate(times, track.positionCount, k, keyTime);
+        auto k1 = std::min(k + 1, track.positionCount - 1);
+        translation = XMVectorLerp(
+          DecodeUNorm16(values + k * 3, track.positionMin, track.positionExtent),
+          DecodeUNorm16(values + k1 * 3, track.positionMin, track.positionExtent), rate);
+      }
+      if (track.rotationCount > 0) {
+        const auto* times = clip.rotationTimes.data() + track.rotationOffset;
+        const auto* values = clip.rotationValues.data() + size_t(track.rotationOffset) * 3;
+        auto k = keys[1] = FindKey(times, track.rotationCount, keyTime, keys[1], rewind);
+        auto rate = GetBlendRate(times, track.rotationCount, k, keyTime);
+        auto k1 = std::min(k + 1, track.rotationCount - 1);
+        rotation = XMQuaternionSlerp(DecodeSmallestThree(values + k * 3), DecodeSmallestThree(values + k1 * 3), rate);
+      }
+      if (track.scaleCount > 0) {
+        const auto* times = clip.scaleTimes.data() + track.scaleOffset;
+        const auto* values = clip.scaleValues.data() + size_t(track.scaleOffset) * 3;
+        auto k = keys[2] = FindKey(times, track.scaleCount, keyTime, keys[2], rewind);
+        auto rate = GetBlendRate(times, track.scaleCount, k, keyTime);
+        auto k1 = std::min(k + 1, track.scaleCount - 1);
+        scale = XMVectorLerp(
+          DecodeUNorm16(values + k * 3, track.scaleMin, track.scaleExtent),
+          DecodeUNorm16(values + k1 * 3, track.scaleMin, track.scaleExtent), rate);
+      }
+      ApplyPose(skeleton, track.node, track.positionCount, track.rotationCount, track.scaleCount, translation, rotation, scale);
+    }
+  }
+
+  CompressedClip CompressClip(const AnimationClip& clip, const model::Skeleton& skeleton, float tolerance) {
+    // 回転/スケールの誤差を距離に換算するため, 各ノードから子ノードまでの最大距離を求める.
+    std::vector<float> reach(skeleton.GetNodeCount(), 0.0f);
+    for (int i = 0; i < skeleton.GetNodeCount(); ++i) {
+      int parent = skeleton.GetParent(i);
+      if (parent != model::Skeleton::InvalidNode) {
+        float length = XMVectorGetX(XMVector3Length(skeleton.GetLocalTransform(i).r[3]));
+        reach[parent] = std::max(reach[parent], length);
+      }
+    }
+    // 末端のノードでも最低限の精度を保つ.
+    float minReach = 0.0f;
+    for (auto r : reach) {
+      minReach = std::max(minReach, r);
+    }
+    minReach *= 0.1f;
+
+    // 間引きと量子化で誤差を半分ずつ使う.
+    const float reduceTolerance = tolerance * 0.5f;
+
+    CompressedClip result;
+    result.name = clip.name;
+    result.duration = clip.duration;
+    auto quantizeTime = [&](float t) {
+      return clip.duration > 0.0f ? QuantizeUNorm16(t / clip.duration) : uint16_t(0);
+    };
+
+    for (const auto& track : clip.tracks) {
+      CompressedTrack dst{};
+      dst.node = track.node;
+      float nodeReach = std::max(reach[track.node], minReach);
+
+      // 位置.
+      {
+        const auto* times = clip.positionTimes.data() + track.positionOffset;
+        const auto* values = clip.positionValues.data() + track.positionOffset;
+        auto kept = ReduceKeys(times, track.positionCount, [&](uint32_t a, uint32_t b, uint32_t k, float rate) {
+          auto v = XMVectorLerp(XMLoadFloat3(&values[a]), XMLoadFloat3(&values[b]), rate);
+          return XMVectorGetX(XMVector3Length(v - XMLoadFloat3(&values[k]))) <= reduceTolerance;
+        });
+        XMVECTOR vMin = XMVectorReplicate(FLT_MAX), vMax = XMVectorReplicate(-FLT_MAX);
+        for (auto k : kept) {
+          vMin = XMVectorMin(vMin, XMLoadFloat3(&values[k]));
+          vMax = XMVectorMax(vMax, XMLoadFloat3(&values[k]));
+        }
+        if (!kept.empty()) {
+          XMStoreFloat3(&dst.positionMin, vMin);
+          XMStoreFloat3(&dst.positionExtent, vMax - vMin);
+        }
+        auto invExtent = XMVectorReciprocal(XMVectorMax(vMax - vMin, XMVectorReplicate(1.0e-8f)));
+        dst.positionOffset = uint32_t(result.positionTimes.size());
+        dst.positionCount = uint32_t(kept.size());
+        for (auto k : kept) {
+          XMFLOAT3 n;
+          XMStoreFloat3(&n, (XMLoadFloat3(&values[k]) - vMin) * invExtent);
+          result.positionTimes.push_back(quantizeTime(times[k]));
+          result.positionValues.push_back(QuantizeUNorm16(n.x));
+          result.positionValues.push_back(QuantizeUNorm16(n.y));
+          result.positionValues.push_back(QuantizeUNorm16(n.z));
+        }
+      }
+
+      // 回転. 角度の誤差に子ノードまでの距離を掛けて距離の誤差とする.
+      {
+        const auto* times = clip.rotationTimes.data() + track.rotationOffset;
+        const auto* values = clip.rotationValues.data() + track.rotationOffset;
+        auto kept = ReduceKeys(times, track.rotationCount, [&](uint32_t a, uint32_t b, uint32_t k, float rate) {
+          auto q = XMQuaternionSlerp(XMLoadFloat4(&values[a]), XMLoadFloat4(&values[b]), rate);
+          float d = std::min(std::abs(XMVectorGetX(XMVector4Dot(q, XMLoadFloat4(&values[k])))), 1.0f);
+          float angle = 2.0f * std::acos(d);
+          return angle * nodeReach <= reduceTolerance;
+        });
+        dst.rotationOffset = uint32_t(result.rotationTimes.size());
+        dst.rotationCount = uint32_t(kept.size());
+        for (auto k : kept) {
+          uint16_t encoded[3];
+          EncodeSmallestThree(XMLoadFloat4(&values[k]), encoded);
+          result.rotationTimes.push_back(quantizeTime(times[k]));
+          result.rotationValues.insert(result.rotationValues.end(), encoded, encoded + 3);
+        }
+      }
+
+      // スケール.
+      {
+        const auto* times = clip.scaleTimes.data() + track.scaleOffset;
+        const auto* values = clip.scaleValues.data() + track.scaleOffset;
+        auto kept = ReduceKeys(times, track.scaleCount, [&](uint32_t a, uint32_t b, uint32_t k, float rate) {
+          auto v = XMVectorLerp(XMLoadFloat3(&values[a]), XMLoadFloat3(&values[b]), rate);
+          auto diff = XMVectorAbs(v - XMLoadFloat3(&values[k]));
+          float maxDiff = std::max({ XMVectorGetX(diff), XMVectorGetY(diff), XMVectorGetZ(diff) });
+          return maxDiff * nodeReach <= reduceTolerance;
+        });
+        XMVECTOR vMin = XMVectorReplicate(FLT_MAX), vMax = XMVectorReplicate(-FLT_MAX);
+        for (auto k : kept) {
+          vMin = XMVectorMin(vMin, XMLoadFloat3(&values[k]));
+          vMax = XMVectorMax(vMax, XMLoadFloat3(&values[k]));
+        }
+        if (!kept.empty()) {
+          XMStoreFloat3(&dst.scaleMin, vMin);
+          XMStoreFloat3(&dst.scaleExtent, vMax - vMin);
+        }
+        auto invExtent = XMVectorReciprocal(XMVectorMax(vMax - vMin, XMVectorReplicate(1.0e-8f)));
+        dst.scaleOffset = uint32_t(result.scaleTimes.size());
+        dst.scaleCount = uint32_t(kept.size());
+        for (auto k : kept) {
+          XMFLOAT3 n;
+          XMStoreFloat3(&n, (XMLoadFloat3(&values[k]) - vMin) * invExtent);
+          result.scaleTimes.push_back(quantizeTime(times[k]));
+          result.scaleValues.push_back(QuantizeUNorm16(n.x));
+          result.scaleValues.push_back(QuantizeUNorm16(n.y));
+          result.scaleValues.push_back(QuantizeUNorm16(n.z));
+        }
+      }
+      result.tracks.push_back(dst);
+    }
+    return result;
+  }
+}
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+#include "Skeleton.h"
+
+// スケルタルアニメーションのクリップとサンプリング.
+// キーはクリップ単位で種類ごとの連続した配列にまとめ, トラックはその範囲を持つ.
+namespace animation {
+  struct Track {
+    int node;     // Skeleton のノード番号.
+    uint32_t positionOffset, positionCount;
+    uint32_t rotationOffset, rotationCount;
+    uint32_t scaleOffset, scaleCount;
+  };
+
+  struct AnimationClip {
+    std::string name;
+    float duration = 0.0f;  // 秒.
+    std::vector<Track> tracks;
+
+    std::vector<float> positionTimes;
+    std::vector<DirectX::XMFLOAT3> positionValues;
+    std::vector<float> rotationTimes;
+    std::vector<DirectX::XMFLOAT4> rotationValues;  // クォータニオン.
+    std::vector<float> scaleTimes;
+    std::vector<DirectX::XMFLOAT3> scaleValues;
+  };
+
+  // 圧縮済みクリップ. 補間で再現できるキーを間引き, 回転は smallest-three の 48bit,
+  // 位置/スケールはトラックごとの範囲で正規化した 16bit, 時刻は duration で正規化した 16bit で持つ.
+  struct CompressedTrack {
+    int node;
+    uint32_t positionOffset, positionCount;
+    uint32_t rotationOffset, rotationCount;
+    uint32_t scaleOffset, scaleCount;
+    DirectX::XMFLOAT3 positionMin, positionExtent;
+    DirectX::XMFLOAT3 scaleMin, scaleExtent;
+  };
+
+  struct CompressedClip {
+    std::string name;
+    float duration = 0.0f;
+    std::vector<CompressedTrack> tracks;
+
+    std::vector<uint16_t> positionTimes, rotationTimes, scaleTimes;
+    std::vector<uint16_t> positionValues;   // 1 キーあたり 3 要素.
+    std::vector<uint16_t> rotationValues;
+    std::vector<uint16_t> scaleValues;
+  };
+
+  size_t GetMemorySize(const AnimationClip& clip);
+  size_t GetMemorySize(const CompressedClip& clip);
+
+  // tolerance はモデル空間での許容誤差. 回転/スケールの誤差は子ノードまでの距離を掛けて評価する.
+  CompressedClip CompressClip(const AnimationClip& clip, const model::Skeleton& skeleton, float tolerance);
+
+  // トラックごとに直前に使ったキーの位置を覚えておき,
+  // 時刻が前に進む通常の再生ではキーの探索を二分探索でなく数ステップで済ませる.
+  class SampleCursor {
+  public:
+    void Reset(const void* clip, size_t trackCount);
+
+  private:
+    friend void SampleClip(const AnimationClip&, float, SampleCursor&, model::Skeleton&, bool);
+    friend void SampleClip(const CompressedClip&, float, SampleCursor&, model::Skeleton&, bool);
+
+    std::vector<uint32_t> m_keys;   // トラックごとに位置/回転/スケールの 3 つ.
+    float m_lastTime = 0.0f;
+    const void* m_clip = nullptr;
+  };
+
+  // time (秒) の姿勢を求め, 対応するノードのローカル行列へ書き込む.
+  // loop が true なら duration で折り返す.
+  void SampleClip(const AnimationClip& clip, float time, SampleCursor& cursor, model::Skeleton& skeleton, bool loop = true);
+  void SampleClip(const CompressedClip& clip, float time, SampleCursor& cursor, model::Skeleton& skeleton, bool loop = true);
+}
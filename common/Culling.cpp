@@ -0,0 +1,68 @@
+#include "Culling.h"
+
+using namespace DirectX;
+
+namespace culling {
+  void BoundsList::Clear() {
+    m_groups.clear();
+    m_count = 0;
+  }
+
+  void BoundsList::Add(const XMFLOAT3& center, const XMFLOAT3& extents) {
+    auto lane = m_count % 4;
+    if (lane == 0) {
+      auto zero = XMVectorZero();
+      m_groups.push_back({ zero, zero, zero, zero, zero, zero });
+    }
+    auto& g = m_groups.back();
+    g.centerX = XMVectorSetByIndex(g.centerX, center.x, lane);
+    g.centerY = XMVectorSetByIndex(g.centerY, center.y, lane);
+    g.centerZ = XMVectorSetByIndex(g.centerZ, center.z, lane);
+    g.extentX = XMVectorSetByIndex(g.extentX, extents.x, lane);
+    g.extentY = XMVectorSetByIndex(g.extentY, extents.y, lane);
+    g.extentZ = XMVectorSetByIndex(g.extentZ, extents.z, lane);
+    m_count++;
+  }
+
+  void CullBounds(const BoundsList& bounds, const XMFLOAT4 planes[6], std::vector<uint32_t>& visible) {
+    visible.clear();
+
+    // 平面の各成分をあらかじめ 4 要素に複製しておく.
+    XMVECTOR planeX[6], planeY[6], planeZ[6], planeW[6];
+    XMVECTOR absX[6], absY[6], absZ[6];
+    for (int i = 0; i < 6; ++i) {
+      planeX[i] = XMVectorReplicate(planes[i].x);
+      planeY[i] = XMVectorReplicate(planes[i].y);
+      planeZ[i] = XMVectorReplicate(planes[i].z);
+      planeW[i] = XMVectorReplicate(planes[i].w);
+      absX[i] = XMVectorAbs(planeX[i]);
+      absY[i] = XMVectorAbs(planeY[i]);
+      absZ[i] = XMVectorAbs(planeZ[i]);
+    }
+
+    auto zero = XMVectorZero();
+    for (uint32_t g = 0; g < uint32_t(bounds.m_groups.size()); ++g) {
+      const auto& group = bounds.m_groups[g];
+      auto inside = XMVectorTrueInt();
+      for (int i = 0; i < 6; ++i) {
+        // 中心の符号付き距離と, 平面法線方向への AABB の半径.
+        auto distance = XMVectorMultiplyAdd(group.centerX, planeX[i],
+          XMVectorMultiplyAdd(group.centerY, planeY[i],
+            XMVectorMultiplyAdd(group.centerZ, planeZ[i], planeW[i])));
+        auto radius = XMVectorMultiplyAdd(group.extentX, absX[i],
+          XMVectorMultiplyAdd(group.extentY, absY[i], group.extentZ * absZ[i]));
+        inside = XMVectorAndInt(inside, XMVectorGreaterOrEqual(distance + radius, zero));
+      }
+
+      XMUINT4 mask;
+      XMStoreUInt4(&mask, inside);
+      const uint32_t lanes[4] = { mask.x, mask.y, mask.z, mask.w };
+      for (uint32_t lane = 0; lane < 4; ++lane) {
+        auto index = g * 4 + lane;
+        if (lanes[lane] && index < bounds.m_count) {
+          visible.push_back(index);
+        }
+      }
+    }
+  }
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+
+// 多数の AABB を視錐台に対してまとめて判定する.
+namespace culling {
+  // 4 個ずつ SIMD で判定するため, 中心と半径を成分ごとに 4 要素単位で保持する.
+  class BoundsList {
+  public:
+    void Clear();
+    void Add(const DirectX::XMFLOAT3& center, const DirectX::XMFLOAT3& extents);
+    uint32_t GetCount() const { return m_count; }
+
+  private:
+    friend void CullBounds(const BoundsList&, const DirectX::XMFLOAT4[6], std::vector<uint32_t>&);
+
+    struct Group {
+      DirectX::XMVECTOR centerX, centerY, centerZ;
+      DirectX::XMVECTOR extentX, extentY, extentZ;
+    };
+    std::vector<Group> m_groups;
+    uint32_t m_count = 0;
+  };
+
+  // planes は内側が正となる平面 (book_util::ExtractFrustumPlanes の出力).
+  // 視錐台と交差する要素の番号を visible に昇順で書き込む.
+  void CullBounds(const BoundsList& bounds, const DirectX::XMFLOAT4 planes[6], std::vector<uint32_t>& visible);
+}
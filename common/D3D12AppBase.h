@@ -1,219 +1,243 @@
-#pragma once
-#define WIN32_LEAN_AND_MEAN
-#define NOMINMAX
-#include <d3d12.h>
-#include <dxgi1_6.h>
-
-#include "d3dx12.h"
-#include <wrl.h>
-
-#include "DescriptorManager.h"
-#include "Swapchain.h"
-#include <memory>
-#include <string>
-#include <unordered_map>
-
-#pragma comment(lib, "d3d12.lib")
-#pragma comment(lib, "dxgi.lib")
-
-class D3D12AppBase
-{
-public:
-  template<class T>
-  using ComPtr = Microsoft::WRL::ComPtr<T>;
-
-  D3D12AppBase();
-  virtual ~D3D12AppBase();
-
-  void Initialize(HWND hWnd, DXGI_FORMAT format, bool isFullScreen, bool useWaitableSwapchain = false);
-  void Terminate();
-
-  virtual void Render();// = 0;
-
-  virtual void Prepare() { }
-  virtual void Cleanup() { }
-
-  const UINT GpuWaitTimeout = (10 * 1000);  // 10s
-  static const UINT FrameBufferCount = 2;
-
-  virtual void OnSizeChanged(UINT width, UINT height, bool isMinimized);
-  virtual void OnMouseButtonDown(UINT msg) { }
-  virtual void OnMouseButtonUp(UINT msg) { }
-  virtual void OnMouseMove(UINT msg, int dx, int dy) { }
-
-
-  void SetTitle(const std::string& title);
-  void ToggleFullscreen();
-
-  ComPtr<ID3D12Device> GetDevice() { return m_device; }
-  std::shared_ptr<Swapchain> GetSwapchain() { return m_swapchain; }
-  ComPtr<IDXGIAdapter1> GetAdapter() { return m_adapter; }
-  // \[X
-  ComPtr<ID3D12Resource1> CreateResource(
-    const CD3DX12_RESOURCE_DESC& desc, 
-    D3D12_RESOURCE_STATES resourceStates, 
-    const D3D12_CLEAR_VALUE* clearValue,
-    D3D12_HEAP_TYPE heapType
-  );
-  std::vector<ComPtr<ID3D12Resource1>> CreateConstantBuffers(
-    const CD3DX12_RESOURCE_DESC& desc,
-    int count = FrameBufferCount
-  );
-
-  // R}hobt@֘A
-  ComPtr<ID3D12GraphicsCommandList>  CreateCommandList();
-  void FinishCommandList(ComPtr<ID3D12GraphicsCommandList>& command);
-  ComPtr<ID3D12GraphicsCommandList> CreateBundleCommandList();
-
-  void WriteToUploadHeapMemory(ID3D12Resource1* resource, uint32_t size, const void* pData);
-
-  std::shared_ptr<DescriptorManager> GetDescriptorManager() { return m_heap; }
-
-  using Buffer = ComPtr<ID3D12Resource1>;
-
-  struct Texture {
-    ComPtr<ID3D12Resource1> res;
-    DescriptorHandle srv;
-  };
-
-
-  struct SimpleModelData
-  {
-    UINT indexCount;
-    UINT vertexCount;
-    D3D12_VERTEX_BUFFER_VIEW vbView;
-    D3D12_INDEX_BUFFER_VIEW  ibView;
-    Buffer resourceVB;
-    Buffer resourceIB;
-  };
-
-  // Pf̃f[^GPU֓].
-  template<class T>
-  SimpleModelData CreateSimpleModel(const std::vector<T>& vertices, const std::vector<uint32_t>& indices)
-  {
-    SimpleModelData model;
-    auto bufferSize = uint32_t(sizeof(T)*vertices.size());
-    auto vbDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
-    auto srcHeapType = D3D12_HEAP_TYPE_UPLOAD;
-    auto dstHeapType = D3D12_HEAP_TYPE_DEFAULT;
-
-    model.resourceVB = CreateResource(vbDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, dstHeapType);
-    auto uploadVB = CreateResource(vbDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, srcHeapType);
-    WriteToUploadHeapMemory(uploadVB.Get(), bufferSize, vertices.data());
-
-    bufferSize = UINT(sizeof(UINT)*indices.size());
-    auto ibDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
-    model.resourceIB = CreateResource(ibDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, dstHeapType);
-    auto uploadIB = CreateResource(ibDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, srcHeapType);
-    WriteToUploadHeapMemory(uploadIB.Get(), bufferSize, indices.data());
-
-    auto command = CreateCommandList();
-    command->CopyResource(model.resourceVB.Get(), uploadVB.Get());
-    command->CopyResource(model.resourceIB.Get(), uploadIB.Get());
-
-    D3D12_RESOURCE_BARRIER barriers[] = {
-      CD3DX12_RESOURCE_BARRIER::Transition(
-        model.resourceVB.Get(), 
-        D3D12_RESOURCE_STATE_COPY_DEST,
-        D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER),
-      CD3DX12_RESOURCE_BARRIER::Transition(
-        model.resourceIB.Get(),
-        D3D12_RESOURCE_STATE_COPY_DEST,
-        D3D12_RESOURCE_STATE_INDEX_BUFFER)
-    };
-    command->ResourceBarrier(_countof(barriers), barriers);
-    FinishCommandList(command);
-
-    model.indexCount = UINT(indices.size());
-    model.vertexCount = UINT(vertices.size());
-
-    model.vbView.BufferLocation = model.resourceVB->GetGPUVirtualAddress();
-    model.vbView.StrideInBytes = sizeof(T);
-    model.vbView.SizeInBytes = UINT(model.vbView.StrideInBytes * vertices.size());
-    model.ibView.BufferLocation = model.resourceIB->GetGPUVirtualAddress();
-    model.ibView.Format = DXGI_FORMAT_R32_UINT;
-    model.ibView.SizeInBytes = UINT(sizeof(UINT) * indices.size());
-
-    return model;
-  }
-
-  Texture LoadTexture(std::string filename, 
-    D3D12_RESOURCE_STATES resourceStates = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
-    ComPtr<ID3D12GraphicsCommandList> commandList = nullptr);
-
-  ComPtr<IDXGIAdapter1> m_adapter;
-protected:
-
-  void PrepareDescriptorHeaps();
-  
-  void CreateDefaultDepthBuffer(int width, int height);
-  void CreateCommandAllocators();
-  void WaitForIdleGPU();
-
-  // ImGui
-  void PrepareImGui();
-  void CleanupImGui();
-
-  ComPtr<ID3D12Device> m_device;
-  ComPtr<ID3D12CommandQueue> m_commandQueue;
- 
-  std::shared_ptr<Swapchain> m_swapchain;
-
-  std::vector<ComPtr<ID3D12Resource1>> m_renderTargets;
-  ComPtr<ID3D12Resource1> m_depthBuffer;
-
-  CD3DX12_VIEWPORT  m_viewport;
-  CD3DX12_RECT m_scissorRect;
-  DXGI_FORMAT  m_surfaceFormat;
-
-  
-  std::vector<ComPtr<ID3D12CommandAllocator>> m_commandAllocators;
-  ComPtr<ID3D12CommandAllocator> m_oneshotCommandAllocator;
-  ComPtr<ID3D12CommandAllocator> m_bundleCommandAllocator;
-
-  std::shared_ptr<DescriptorManager> m_heapRTV;
-  std::shared_ptr<DescriptorManager> m_heapDSV;
-  std::shared_ptr<DescriptorManager> m_heap;
-
-  DescriptorHandle m_defaultDepthDSV;
-  ComPtr<ID3D12GraphicsCommandList> m_commandList;
-  HANDLE m_waitFence;
-
-  UINT m_frameIndex;
-
-  UINT m_width;
-  UINT m_height;
-  bool m_isAllowTearing;
-  HWND m_hwnd;
-
-  // --------
-  std::unordered_map<std::string, Texture> m_textureDatabase;
-  std::vector<ComPtr<ID3D12Resource1>> m_delayReleaseList;
-};
-
-class Shader
-{
-public:
-  Shader() = default;
-  enum Stage
-  {
-    Vertex, Geometry, Pixel,
-    Domain, Hull,
-    Compute,
-  };
-
-  struct DefineMacro {
-    std::wstring Name;
-    std::wstring Value;
-  };
-
-  void load(const std::wstring& fileName, Stage stage,
-    const std::wstring& entryPoint,
-    const std::vector<std::wstring>& flags,
-    const std::vector<DefineMacro>& defines);
-
-  const Microsoft::WRL::ComPtr<ID3DBlob>& getCode() const { return m_code; }
-  D3D12_SHADER_BYTECODE get() const { return D3D12_SHADER_BYTECODE{ m_code->GetBufferPointer(), m_code->GetBufferSize() }; }
-private:
-  Microsoft::WRL::ComPtr<ID3DBlob> m_code;
-};
+#pragma once
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <d3d12.h>
+#include <dxgi1_6.h>
+
+#include "d3dx12.h"
+#include <wrl.h>
+
+#include "DescriptorManager.h"
+#include "Swapchain.h"
+#include "UploadRingBuffer.h"
+#include "UploadManager.h"
+#include "FenceTimeline.h"
+#include "DeferredReleaseQueue.h"
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#pragma comment(lib, "d3d12.lib")
+#pragma comment(lib, "dxgi.lib")
+
+class TextureDecoder;
+
+class D3D12AppBase
+{
+public:
+  template<class T>
+  using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+  D3D12AppBase();
+  virtual ~D3D12AppBase();
+
+  void Initialize(HWND hWnd, DXGI_FORMAT format, bool isFullScreen, bool useWaitableSwapchain = false);
+  void Terminate();
+
+  virtual void Render();// = 0;
+
+  virtual void Prepare() { }
+  virtual void Cleanup() { }
+
+  const UINT GpuWaitTimeout = (10 * 1000);  // 10s
+  static const UINT FrameBufferCount = 2;
+  static const UINT64 UploadRingSize = 16 * 1024 * 1024;
+
+  virtual void OnSizeChanged(UINT width, UINT height, bool isMinimized);
+  virtual void OnMouseButtonDown(UINT msg) { }
+  virtual void OnMouseButtonUp(UINT msg) { }
+  virtual void OnMouseMove(UINT msg, int dx, int dy) { }
+
+
+  void SetTitle(const std::string& title);
+  void ToggleFullscreen();
+
+  ComPtr<ID3D12Device> GetDevice() { return m_device; }
+  std::shared_ptr<Swapchain> GetSwapchain() { return m_swapchain; }
+  ComPtr<IDXGIAdapter1> GetAdapter() { return m_adapter; }
+  // リソース生成
+  ComPtr<ID3D12Resource1> CreateResource(
+    const CD3DX12_RESOURCE_DESC& desc, 
+    D3D12_RESOURCE_STATES resourceStates, 
+    const D3D12_CLEAR_VALUE* clearValue,
+    D3D12_HEAP_TYPE heapType
+  );
+  std::vector<ComPtr<ID3D12Resource1>> CreateConstantBuffers(
+    const CD3DX12_RESOURCE_DESC& desc,
+    int count = FrameBufferCount
+  );
+
+  // コマンドバッファ関連
+  ComPtr<ID3D12GraphicsCommandList>  CreateCommandList();
+  void FinishCommandList(ComPtr<ID3D12GraphicsCommandList>& command);
+  ComPtr<ID3D12GraphicsCommandList> CreateBundleCommandList();
+
+  void WriteToUploadHeapMemory(ID3D12Resource1* resource, uint32_t size, const void* pData);
+  // 記録中のコマンドで使ったリソースを, グラフィックスキューの実行が終わるまで保持しておく.
+  void DelayRelease(ComPtr<ID3D12Resource1> resource) { m_releaseQueue->Release(resource); }
+  // GPU が使用中かもしれないリソースやディスクリプタの解放先. 完了分はフレーム毎に回収される.
+  std::shared_ptr<DeferredReleaseQueue> GetReleaseQueue() { return m_releaseQueue; }
+
+  std::shared_ptr<DescriptorManager> GetDescriptorManager() { return m_heap; }
+  // フレーム毎に使い捨てる定数などの確保先.
+  std::shared_ptr<UploadRingBuffer> GetUploadRing() { return m_uploadRing; }
+  // 起動時の読み込みなどの転送をコピーキューでまとめて行う.
+  std::shared_ptr<UploadManager> GetUploadManager() { return m_uploadManager; }
+  // m_commandQueue のタイムラインフェンス. フレームの同期や待機はこれを使う.
+  std::shared_ptr<FenceTimeline> GetGraphicsTimeline() { return m_graphicsTimeline; }
+  // 積まれた転送を発行し, 以降のグラフィックスキューの処理にその完了を GPU 側で待たせる.
+  // Prepare の後, WaitForIdleGPU と FinishCommandList の前には自動で呼ばれる.
+  void FlushUploads();
+  // テクスチャのデコードを行うワーカー. LoadTexture より前に Request しておくと並列にデコードされる.
+  std::shared_ptr<TextureDecoder> GetTextureDecoder() { return m_textureDecoder; }
+
+  using Buffer = ComPtr<ID3D12Resource1>;
+
+  struct Texture {
+    ComPtr<ID3D12Resource1> res;
+    DescriptorHandle srv;
+  };
+
+
+  struct SimpleModelData
+  {
+    UINT indexCount;
+    UINT vertexCount;
+    D3D12_VERTEX_BUFFER_VIEW vbView;
+    D3D12_INDEX_BUFFER_VIEW  ibView;
+    Buffer resourceVB;
+    Buffer resourceIB;
+  };
+
+  // 単純モデルのデータをGPUへ転送.
+  template<class T>
+  SimpleModelData CreateSimpleModel(const std::vector<T>& vertices, const std::vector<uint32_t>& indices)
+  {
+    SimpleModelData model;
+    auto bufferSize = uint32_t(sizeof(T)*vertices.size());
+    auto vbDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
+    auto dstHeapType = D3D12_HEAP_TYPE_DEFAULT;
+
+    model.resourceVB = CreateResource(vbDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, dstHeapType);
+    m_uploadManager->UploadBuffer(model.resourceVB.Get(), 0, vertices.data(), bufferSize);
+
+    // 頂点数が 65536 以下なら 16bit インデックスで格納する.
+    auto indexFormat = DXGI_FORMAT_R32_UINT;
+    const void* indexData = indices.data();
+    std::vector<uint16_t> indices16;
+    bufferSize = UINT(sizeof(UINT)*indices.size());
+    if (vertices.size() <= 65536) {
+      indices16.assign(indices.begin(), indices.end());
+      indexFormat = DXGI_FORMAT_R16_UINT;
+      indexData = indices16.data();
+      bufferSize = UINT(sizeof(uint16_t)*indices16.size());
+    }
+    auto ibDesc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
+    model.resourceIB = CreateResource(ibDesc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, dstHeapType);
+    m_uploadManager->UploadBuffer(model.resourceIB.Get(), 0, indexData, bufferSize);
+    // 転送はコピーキューで行い, 完了後は COMMON から頂点/インデックスバッファへ暗黙に昇格する.
+
+    model.indexCount = UINT(indices.size());
+    model.vertexCount = UINT(vertices.size());
+
+    model.vbView.BufferLocation = model.resourceVB->GetGPUVirtualAddress();
+    model.vbView.StrideInBytes = sizeof(T);
+    model.vbView.SizeInBytes = UINT(model.vbView.StrideInBytes * vertices.size());
+    model.ibView.BufferLocation = model.resourceIB->GetGPUVirtualAddress();
+    model.ibView.Format = indexFormat;
+    model.ibView.SizeInBytes = bufferSize;
+
+    return model;
+  }
+
+  // LoadTexture 済みのテクスチャのキー (TextureDecoder::GetRequestKey). デコードの予約を省くのに使う.
+  std::unordered_set<std::string> GetLoadedTextureKeys() const;
+
+  // generateMips を指定するとミップマップの無い非圧縮テクスチャにミップを生成する.
+  // 先行して Request する場合も同じ指定にすること.
+  Texture LoadTexture(std::string filename, 
+    D3D12_RESOURCE_STATES resourceStates = D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE,
+    ComPtr<ID3D12GraphicsCommandList> commandList = nullptr,
+    bool generateMips = false);
+
+  ComPtr<IDXGIAdapter1> m_adapter;
+protected:
+
+  void PrepareDescriptorHeaps();
+  
+  void CreateDefaultDepthBuffer(int width, int height);
+  void CreateCommandAllocators();
+  void WaitForIdleGPU();
+
+  // ImGui
+  void PrepareImGui();
+  void CleanupImGui();
+
+  ComPtr<ID3D12Device> m_device;
+  ComPtr<ID3D12CommandQueue> m_commandQueue;
+ 
+  std::shared_ptr<Swapchain> m_swapchain;
+
+  std::vector<ComPtr<ID3D12Resource1>> m_renderTargets;
+  ComPtr<ID3D12Resource1> m_depthBuffer;
+
+  CD3DX12_VIEWPORT  m_viewport;
+  CD3DX12_RECT m_scissorRect;
+  DXGI_FORMAT  m_surfaceFormat;
+
+  
+  std::vector<ComPtr<ID3D12CommandAllocator>> m_commandAllocators;
+  ComPtr<ID3D12CommandAllocator> m_oneshotCommandAllocator;
+  ComPtr<ID3D12CommandAllocator> m_bundleCommandAllocator;
+
+  std::shared_ptr<DescriptorManager> m_heapRTV;
+  std::shared_ptr<DescriptorManager> m_heapDSV;
+  std::shared_ptr<DescriptorManager> m_heap;
+  std::shared_ptr<UploadRingBuffer> m_uploadRing;
+  std::shared_ptr<TextureDecoder> m_textureDecoder;
+  std::shared_ptr<UploadManager> m_uploadManager;
+  UINT64 m_uploadWaitValue = 0;   // グラフィックスキューに待たせたコピーキューのフェンス値.
+
+  DescriptorHandle m_defaultDepthDSV;
+  ComPtr<ID3D12GraphicsCommandList> m_commandList;
+  std::shared_ptr<FenceTimeline> m_graphicsTimeline;
+  std::shared_ptr<DeferredReleaseQueue> m_releaseQueue;
+
+  UINT m_frameIndex;
+
+  UINT m_width;
+  UINT m_height;
+  bool m_isAllowTearing;
+  HWND m_hwnd;
+
+  // --------
+  std::unordered_map<std::string, Texture> m_textureDatabase;
+};
+
+class Shader
+{
+public:
+  Shader() = default;
+  enum Stage
+  {
+    Vertex, Geometry, Pixel,
+    Domain, Hull,
+    Compute,
+  };
+
+  struct DefineMacro {
+    std::wstring Name;
+    std::wstring Value;
+  };
+
+  void load(const std::wstring& fileName, Stage stage,
+    const std::wstring& entryPoint,
+    const std::vector<std::wstring>& flags,
+    const std::vector<DefineMacro>& defines);
+
+  const Microsoft::WRL::ComPtr<ID3DBlob>& getCode() const { return m_code; }
+  D3D12_SHADER_BYTECODE get() const { return D3D12_SHADER_BYTECODE{ m_code->GetBufferPointer(), m_code->GetBufferSize() }; }
+private:
+  Microsoft::WRL::ComPtr<ID3DBlob> m_code;
+};
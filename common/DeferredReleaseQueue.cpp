@@ -0,0 +1,83 @@
+#include "DeferredReleaseQueue.h"
+
+#include <algorithm>
+
+DeferredReleaseQueue::DeferredReleaseQueue(std::shared_ptr<FenceTimeline> timeline)
+  : m_timeline(timeline)
+{
+}
+
+DeferredReleaseQueue::~DeferredReleaseQueue()
+{
+  Flush();
+}
+
+void DeferredReleaseQueue::Release(ComPtr<IUnknown> object)
+{
+  Release(object, GetCurrentFenceValue());
+}
+
+void DeferredReleaseQueue::Release(ComPtr<IUnknown> object, UINT64 fenceValue)
+{
+  if (object) {
+    Push(Entry{ fenceValue, object, DescriptorHandle(), nullptr });
+  }
+}
+
+void DeferredReleaseQueue::Release(const DescriptorHandle& handle, std::shared_ptr<DescriptorManager> heap)
+{
+  Release(handle, heap, GetCurrentFenceValue());
+}
+
+void DeferredReleaseQueue::Release(const DescriptorHandle& handle, std::shared_ptr<DescriptorManager> heap, UINT64 fenceValue)
+{
+  if (handle && heap) {
+    Push(Entry{ fenceValue, nullptr, handle, heap });
+  }
+}
+
+void DeferredReleaseQueue::Push(Entry&& entry)
+{
+  // 登録の度に完了済みのものを回収しておく.
+  Collect();
+  m_entries.emplace_back(std::move(entry));
+}
+
+void DeferredReleaseQueue::Collect()
+{
+  if (m_entries.empty()) {
+    return;
+  }
+  auto completedValue = m_timeline->GetCompletedValue();
+  auto it = std::stable_partition(m_entries.begin(), m_entries.end(),
+    [completedValue](const Entry& e) { return e.fenceValue > completedValue; });
+  for (auto i = it; i != m_entries.end(); ++i) {
+    Retire(*i);
+  }
+  m_entries.erase(it, m_entries.end());
+}
+
+void DeferredReleaseQueue::Flush()
+{
+  if (m_entries.empty()) {
+    return;
+  }
+  UINT64 maxValue = 0;
+  for (const auto& e : m_entries) {
+    maxValue = (std::max)(maxValue, e.fenceValue);
+  }
+  // まだシグナルされていない値は待てないので, ここで発行する.
+  if (maxValue > m_timeline->GetLastSignaledValue()) {
+    maxValue = m_timeline->Signal();
+  }
+  m_timeline->Wait(maxValue);
+  Collect();
+}
+
+void DeferredReleaseQueue::Retire(Entry& entry)
+{
+  if (entry.heap) {
+    entry.heap->Free(entry.handle);
+  }
+  entry.object.Reset();
+}
@@ -0,0 +1,49 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <vector>
+#include <memory>
+
+#include "DescriptorManager.h"
+#include "FenceTimeline.h"
+
+// GPU が使い終わるまでリソースやディスクリプタの解放を遅らせるキュー.
+// 最後に使用したコマンドのフェンス値と一緒に登録し, その値が完了したら Collect で解放する.
+// FenceTimeline と同じくメインスレッドから使用すること.
+class DeferredReleaseQueue
+{
+public:
+  template<class T>
+  using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+  // timeline は登録するリソースを使うコマンドを発行するキューのもの.
+  explicit DeferredReleaseQueue(std::shared_ptr<FenceTimeline> timeline);
+  ~DeferredReleaseQueue();
+
+  // fenceValue を省略した場合は, 記録中のコマンド (次にシグナルされる値) で最後に使われたとみなす.
+  void Release(ComPtr<IUnknown> object);
+  void Release(ComPtr<IUnknown> object, UINT64 fenceValue);
+  // ディスクリプタは完了後に heap へ返却する.
+  void Release(const DescriptorHandle& handle, std::shared_ptr<DescriptorManager> heap);
+  void Release(const DescriptorHandle& handle, std::shared_ptr<DescriptorManager> heap, UINT64 fenceValue);
+
+  // 完了したものを解放する. 毎フレーム呼び出すこと.
+  void Collect();
+  // 全ての完了を待って解放する.
+  void Flush();
+
+  size_t GetPendingCount() const { return m_entries.size(); }
+private:
+  struct Entry {
+    UINT64 fenceValue;
+    ComPtr<IUnknown> object;
+    DescriptorHandle handle;
+    std::shared_ptr<DescriptorManager> heap;
+  };
+  UINT64 GetCurrentFenceValue() const { return m_timeline->GetLastSignaledValue() + 1; }
+  void Push(Entry&& entry);
+  void Retire(Entry& entry);
+
+  std::shared_ptr<FenceTimeline> m_timeline;
+  std::vector<Entry> m_entries;
+};
@@ -0,0 +1,243 @@
+#include "DescriptorManager.h"
+
+#include <intrin.h>
+#include <stdexcept>
+#include <algorithm>
+
+namespace {
+  UINT FindMostSignificantBit(UINT value) {
+    unsigned long index;
+    _BitScanReverse(&index, value);
+    return UINT(index);
+  }
+  UINT FindLeastSignificantBit(UINT value) {
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return UINT(index);
+  }
+}
+
+DescriptorManager::DescriptorManager(ComPtr<ID3D12Device> device, const D3D12_DESCRIPTOR_HEAP_DESC& desc)
+  : m_handleCpu(), m_handleGpu(), m_incrementSize(0), m_capacity(desc.NumDescriptors),
+  m_firstLevelBitmap(0), m_used(0), m_peakUsed(0), m_freeBlockCount(0)
+{
+  HRESULT hr = device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_heap));
+  ThrowIfFailed(hr, "CreateDescriptorHeap に失敗.");
+
+  m_handleCpu = m_heap->GetCPUDescriptorHandleForHeapStart();
+  if (desc.Flags & D3D12_DESCRIPTOR_HEAP_FLAG_SHADER_VISIBLE) {
+    m_handleGpu = m_heap->GetGPUDescriptorHandleForHeapStart();
+  }
+  m_incrementSize = device->GetDescriptorHandleIncrementSize(desc.Type);
+
+  m_freeTag.resize(m_capacity, 0);
+  m_allocated.resize(m_capacity, false);
+  m_next.resize(m_capacity, InvalidIndex);
+  m_prev.resize(m_capacity, InvalidIndex);
+  for (UINT fl = 0; fl < FirstLevelCount; ++fl) {
+    m_secondLevelBitmap[fl] = 0;
+    for (UINT sl = 0; sl < SecondLevelCount; ++sl) {
+      m_binHead[fl][sl] = InvalidIndex;
+    }
+  }
+  if (m_capacity > 0) {
+    InsertFreeBlock(0, m_capacity);
+  }
+}
+
+DescriptorHandle DescriptorManager::AllocRange(UINT count)
+{
+  if (count == 0) {
+    return DescriptorHandle();
+  }
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto start = FindFreeBlock(count);
+  if (start == InvalidIndex) {
+    throw std::runtime_error("Descriptor heap is full.");
+  }
+  // 見つけた空き領域の前側を使い, 残りは空き領域に戻す.
+  auto blockSize = m_freeTag[start];
+  RemoveFreeBlock(start, blockSize);
+  if (blockSize > count) {
+    InsertFreeBlock(start + count, blockSize - count);
+  }
+  std::fill(m_allocated.begin() + start, m_allocated.begin() + start + count, true);
+  m_used += count;
+  m_peakUsed = (std::max)(m_peakUsed, m_used);
+  return MakeHandle(start, count);
+}
+
+std::vector<DescriptorHandle> DescriptorManager::Alloc(int num)
+{
+  std::vector<DescriptorHandle> result;
+  if (num <= 0) {
+    return result;
+  }
+  auto range = AllocRange(UINT(num));
+  for (int i = 0; i < num; ++i) {
+    result.push_back(MakeHandle(range.GetIndex() + i, 1));
+  }
+  return result;
+}
+
+void DescriptorManager::Free(const DescriptorHandle& handle)
+{
+  if (handle && handle.GetCount() > 0) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    FreeRange(handle.GetIndex(), handle.GetCount());
+  }
+}
+
+DescriptorHandle DescriptorManager::GetHandle(const DescriptorHandle& base, UINT offset) const
+{
+  return MakeHandle(base.GetIndex() + offset, 1);
+}
+
+DescriptorManager::Stats DescriptorManager::GetStats() const
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  Stats stats{};
+  stats.capacity = m_capacity;
+  stats.used = m_used;
+  stats.peakUsed = m_peakUsed;
+  stats.freeBlockCount = m_freeBlockCount;
+  // 最大の空き領域は一番上のビンにある.
+  if (m_firstLevelBitmap) {
+    auto fl = FindMostSignificantBit(m_firstLevelBitmap);
+    auto sl = FindMostSignificantBit(m_secondLevelBitmap[fl]);
+    for (auto i = m_binHead[fl][sl]; i != InvalidIndex; i = m_next[i]) {
+      stats.largestFreeBlock = (std::max)(stats.largestFreeBlock, m_freeTag[i]);
+    }
+  }
+  return stats;
+}
+
+void DescriptorManager::MapBin(UINT size, UINT& fl, UINT& sl)
+{
+  if (size < SecondLevelCount) {
+    fl = 0;
+    sl = size;
+  } else {
+    auto msb = FindMostSignificantBit(size);
+    fl = msb - SecondLevelBits + 1;
+    sl = (size >> (msb - SecondLevelBits)) - SecondLevelCount;
+  }
+}
+
+UINT DescriptorManager::FindFreeBlock(UINT size) const
+{
+  if (size > m_capacity - m_used) {
+    return InvalidIndex;
+  }
+  // 次のビンの境界に切り上げてから探すと, 見つかった領域は必ず size 以上になる.
+  auto rounded = size;
+  if (rounded >= SecondLevelCount) {
+    rounded += (1u << (FindMostSignificantBit(rounded) - SecondLevelBits)) - 1;
+  }
+  UINT fl, sl;
+  MapBin(rounded, fl, sl);
+  if (fl < FirstLevelCount) {
+    auto slMap = m_secondLevelBitmap[fl] & (~0u << sl);
+    if (slMap == 0) {
+      auto flMap = (fl + 1 < FirstLevelCount) ? (m_firstLevelBitmap & (~0u << (fl + 1))) : 0;
+      if (flMap != 0) {
+        fl = FindLeastSignificantBit(flMap);
+        slMap = m_secondLevelBitmap[fl];
+      }
+    }
+    if (slMap != 0) {
+      return m_binHead[fl][FindLeastSignificantBit(slMap)];
+    }
+  }
+
+  // 空きが少ない時は, 切り上げる前のビンにちょうど入る領域が残っていることがある.
+  MapBin(size, fl, sl);
+  for (auto i = m_binHead[fl][sl]; i != InvalidIndex; i = m_next[i]) {
+    if (m_freeTag[i] >= size) {
+      return i;
+    }
+  }
+  return InvalidIndex;
+}
+
+void DescriptorManager::InsertFreeBlock(UINT start, UINT size)
+{
+  UINT fl, sl;
+  MapBin(size, fl, sl);
+  auto head = m_binHead[fl][sl];
+  m_prev[start] = InvalidIndex;
+  m_next[start] = head;
+  if (head != InvalidIndex) {
+    m_prev[head] = start;
+  }
+  m_binHead[fl][sl] = start;
+  m_secondLevelBitmap[fl] |= 1u << sl;
+  m_firstLevelBitmap |= 1u << fl;
+
+  m_freeTag[start] = size;
+  m_freeTag[start + size - 1] = size;
+  m_freeBlockCount++;
+}
+
+void DescriptorManager::RemoveFreeBlock(UINT start, UINT size)
+{
+  UINT fl, sl;
+  MapBin(size, fl, sl);
+  auto prev = m_prev[start];
+  auto next = m_next[start];
+  if (prev != InvalidIndex) {
+    m_next[prev] = next;
+  } else {
+    m_binHead[fl][sl] = next;
+  }
+  if (next != InvalidIndex) {
+    m_prev[next] = prev;
+  }
+  if (m_binHead[fl][sl] == InvalidIndex) {
+    m_secondLevelBitmap[fl] &= ~(1u << sl);
+    if (m_secondLevelBitmap[fl] == 0) {
+      m_firstLevelBitmap &= ~(1u << fl);
+    }
+  }
+
+  m_freeTag[start] = 0;
+  m_freeTag[start + size - 1] = 0;
+  m_freeBlockCount--;
+}
+
+void DescriptorManager::FreeRange(UINT start, UINT count)
+{
+  if (start >= m_capacity || count > m_capacity - start || count > m_used) {
+    throw std::runtime_error("Invalid descriptor range.");
+  }
+  auto end = start + count;
+  // 範囲内の全てが確保中でなければ解放済み (結合済みの空き領域の内側には空きの印が無い).
+  if (std::find(m_allocated.begin() + start, m_allocated.begin() + end, false) != m_allocated.begin() + end) {
+    throw std::runtime_error("Descriptor range is already freed.");
+  }
+  std::fill(m_allocated.begin() + start, m_allocated.begin() + end, false);
+
+  // 前後の空き領域と結合する.
+  auto blockStart = start;
+  auto blockSize = count;
+  if (start > 0 && m_freeTag[start - 1] != 0) {
+    auto size = m_freeTag[start - 1];
+    RemoveFreeBlock(start - size, size);
+    blockStart -= size;
+    blockSize += size;
+  }
+  if (end < m_capacity && m_freeTag[end] != 0) {
+    auto size = m_freeTag[end];
+    RemoveFreeBlock(end, size);
+    blockSize += size;
+  }
+  InsertFreeBlock(blockStart, blockSize);
+  m_used -= count;
+}
+
+DescriptorHandle DescriptorManager::MakeHandle(UINT index, UINT count) const
+{
+  D3D12_CPU_DESCRIPTOR_HANDLE cpu{ m_handleCpu.ptr + SIZE_T(index) * m_incrementSize };
+  D3D12_GPU_DESCRIPTOR_HANDLE gpu{ m_handleGpu.ptr ? m_handleGpu.ptr + UINT64(index) * m_incrementSize : 0 };
+  return DescriptorHandle(cpu, gpu, index, count);
+}
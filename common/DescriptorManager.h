@@ -1,93 +1,107 @@
-#pragma once
-#include <wrl.h>
-#include <list>
-
-#include "D3D12BookUtil.h"
-#include "d3dx12.h"
-
-class DescriptorHandle
-{
-public:
-  DescriptorHandle() : m_handleCpu(), m_handleGpu(), m_initialized(false) {}
-
-  DescriptorHandle(D3D12_CPU_DESCRIPTOR_HANDLE hCpu, D3D12_GPU_DESCRIPTOR_HANDLE hGpu)
-    : m_handleCpu(hCpu), m_handleGpu(hGpu), m_initialized(true)
-  {
-  }
-
-  operator D3D12_CPU_DESCRIPTOR_HANDLE() const { return m_handleCpu; }
-  operator D3D12_GPU_DESCRIPTOR_HANDLE() const { return m_handleGpu; }
-
-  operator bool() const { return m_initialized; }
-private:
-  D3D12_CPU_DESCRIPTOR_HANDLE m_handleCpu;
-  D3D12_GPU_DESCRIPTOR_HANDLE m_handleGpu;
-  bool m_initialized;
-};
-
-class DescriptorManager
-{
-public:
-  template<class T>
-  using ComPtr = Microsoft::WRL::ComPtr<T>;
-
-  DescriptorManager(ComPtr<ID3D12Device> device, const D3D12_DESCRIPTOR_HEAP_DESC& desc)
-    : m_index(0), m_incrementSize(0)
-  {
-    HRESULT hr = device->CreateDescriptorHeap(&desc, IID_PPV_ARGS(&m_heap));
-    ThrowIfFailed(hr, "CreateDescriptorHeap Ɏs.");
-
-    m_handleCpu = m_heap->GetCPUDescriptorHandleForHeapStart();
-    m_handleGpu = m_heap->GetGPUDescriptorHandleForHeapStart();
-    m_incrementSize = device->GetDescriptorHandleIncrementSize(desc.Type);
-  }
-  ComPtr<ID3D12DescriptorHeap> GetHeap() const { return m_heap; }
-
-  DescriptorHandle Alloc()
-  {
-    if (!m_freeList.empty())
-    {
-      auto ret = m_freeList.front();
-      m_freeList.pop_front();
-      return ret;
-    }
-
-    UINT use = m_index++;
-    auto ret = DescriptorHandle(
-      m_handleCpu.Offset(use, m_incrementSize),
-      m_handleGpu.Offset(use, m_incrementSize)
-    );
-
-    return ret;
-  }
-  std::vector<DescriptorHandle> Alloc(int num) {
-    std::vector<DescriptorHandle> result;
-    UINT use = m_index;
-    for (int i = 0; i < num; ++i) {
-      auto ret = DescriptorHandle(
-        m_handleCpu.Offset(use+i, m_incrementSize),
-        m_handleGpu.Offset(use+i, m_incrementSize)
-      );
-      result.push_back(ret);
-    }
-    m_index += num;
-    return std::move(result);
-  }
-
-  void Free(const DescriptorHandle& handle)
-  {
-    if (handle) {
-      m_freeList.push_back(handle);
-    }
-  }
-
-
-private:
-  ComPtr<ID3D12DescriptorHeap> m_heap;
-  CD3DX12_CPU_DESCRIPTOR_HANDLE m_handleCpu;
-  CD3DX12_GPU_DESCRIPTOR_HANDLE m_handleGpu;
-  UINT m_index;
-  UINT m_incrementSize;
-
-  std::list<DescriptorHandle> m_freeList;
-};
\ No newline at end of file
+#pragma once
+#include <wrl.h>
+#include <vector>
+#include <mutex>
+
+#include "D3D12BookUtil.h"
+#include "d3dx12.h"
+
+class DescriptorHandle
+{
+public:
+  DescriptorHandle() : m_handleCpu(), m_handleGpu(), m_index(0), m_count(0), m_initialized(false) {}
+
+  DescriptorHandle(D3D12_CPU_DESCRIPTOR_HANDLE hCpu, D3D12_GPU_DESCRIPTOR_HANDLE hGpu, UINT index = 0, UINT count = 1)
+    : m_handleCpu(hCpu), m_handleGpu(hGpu), m_index(index), m_count(count), m_initialized(true)
+  {
+  }
+
+  operator D3D12_CPU_DESCRIPTOR_HANDLE() const { return m_handleCpu; }
+  operator D3D12_GPU_DESCRIPTOR_HANDLE() const { return m_handleGpu; }
+
+  operator bool() const { return m_initialized; }
+
+  // ヒープ先頭からの位置と, 連続して確保した個数.
+  UINT GetIndex() const { return m_index; }
+  UINT GetCount() const { return m_count; }
+private:
+  D3D12_CPU_DESCRIPTOR_HANDLE m_handleCpu;
+  D3D12_GPU_DESCRIPTOR_HANDLE m_handleGpu;
+  UINT m_index;
+  UINT m_count;
+  bool m_initialized;
+};
+
+// ディスクリプタヒープを TLSF (Two-Level Segregated Fit) で管理する.
+// 連続した範囲の確保と解放はどちらも O(1) で, 解放時は隣接する空き領域と結合する.
+// 内部でロックするので複数スレッドから呼び出してよい.
+class DescriptorManager
+{
+public:
+  template<class T>
+  using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+  struct Stats {
+    UINT capacity;          // ヒープのディスクリプタ数.
+    UINT used;              // 確保中のディスクリプタ数.
+    UINT peakUsed;          // used の最大値.
+    UINT freeBlockCount;    // 空き領域の個数.
+    UINT largestFreeBlock;  // 一度に確保できる最大の個数.
+
+    // 断片化の度合い (0 なら空きが 1 つに繋がっている).
+    float GetFragmentation() const {
+      auto freeCount = capacity - used;
+      return freeCount > 0 ? 1.0f - float(largestFreeBlock) / float(freeCount) : 0.0f;
+    }
+  };
+
+  DescriptorManager(ComPtr<ID3D12Device> device, const D3D12_DESCRIPTOR_HEAP_DESC& desc);
+  ComPtr<ID3D12DescriptorHeap> GetHeap() const { return m_heap; }
+
+  // 空きが足りない場合は例外を投げる.
+  DescriptorHandle Alloc() { return AllocRange(1); }
+  // count 個の連続したディスクリプタを確保する. 返すハンドルは先頭を指し, Free で範囲ごと解放する.
+  DescriptorHandle AllocRange(UINT count);
+  // 連続した num 個を確保し, 1 つずつのハンドルとして返す. 個別に Free してよい.
+  std::vector<DescriptorHandle> Alloc(int num);
+
+  void Free(const DescriptorHandle& handle);
+
+  // 範囲の先頭ハンドルから offset 個先のハンドルを求める.
+  DescriptorHandle GetHandle(const DescriptorHandle& base, UINT offset) const;
+
+  Stats GetStats() const;
+private:
+  static constexpr UINT SecondLevelBits = 3;
+  static constexpr UINT SecondLevelCount = 1 << SecondLevelBits;
+  static constexpr UINT FirstLevelCount = 32 - SecondLevelBits + 1;
+  static constexpr UINT InvalidIndex = ~0u;
+
+  static void MapBin(UINT size, UINT& fl, UINT& sl);
+  UINT FindFreeBlock(UINT size) const;
+  void InsertFreeBlock(UINT start, UINT size);
+  void RemoveFreeBlock(UINT start, UINT size);
+  void FreeRange(UINT start, UINT count);
+  DescriptorHandle MakeHandle(UINT index, UINT count) const;
+
+  ComPtr<ID3D12DescriptorHeap> m_heap;
+  D3D12_CPU_DESCRIPTOR_HANDLE m_handleCpu;
+  D3D12_GPU_DESCRIPTOR_HANDLE m_handleGpu;
+  UINT m_incrementSize;
+  UINT m_capacity;
+
+  mutable std::mutex m_mutex;
+  // 空き領域の先頭と末尾にだけ大きさを書いておく (それ以外は 0).
+  std::vector<UINT> m_freeTag;
+  // 確保中のディスクリプタの印. 二重解放の検出に使う.
+  std::vector<bool> m_allocated;
+  // 空き領域の先頭位置で引く, 同じビンのリストのリンク.
+  std::vector<UINT> m_next, m_prev;
+  UINT m_firstLevelBitmap;
+  UINT m_secondLevelBitmap[FirstLevelCount];
+  UINT m_binHead[FirstLevelCount][SecondLevelCount];
+
+  UINT m_used;
+  UINT m_peakUsed;
+  UINT m_freeBlockCount;
+};
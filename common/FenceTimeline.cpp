@@ -0,0 +1,66 @@
+#include "FenceTimeline.h"
+
+FenceTimeline::FenceTimeline(ComPtr<ID3D12Device> device, ComPtr<ID3D12CommandQueue> queue)
+  : m_queue(queue), m_lastSignaled(0), m_lastCompleted(0)
+{
+  HRESULT hr = device->CreateFence(0, D3D12_FENCE_FLAG_NONE, IID_PPV_ARGS(&m_fence));
+  ThrowIfFailed(hr, "CreateFence 失敗");
+  m_waitEvent = CreateEvent(NULL, FALSE, FALSE, NULL);
+}
+
+FenceTimeline::~FenceTimeline()
+{
+  CloseHandle(m_waitEvent);
+}
+
+UINT64 FenceTimeline::Signal()
+{
+  auto value = m_lastSignaled + 1;
+  HRESULT hr = m_queue->Signal(m_fence.Get(), value);
+  ThrowIfFailed(hr, "Signal 失敗");
+  m_lastSignaled = value;
+  return value;
+}
+
+bool FenceTimeline::IsComplete(UINT64 value) const
+{
+  if (value <= m_lastCompleted) {
+    return true;
+  }
+  return GetCompletedValue() >= value;
+}
+
+UINT64 FenceTimeline::GetCompletedValue() const
+{
+  m_lastCompleted = m_fence->GetCompletedValue();
+  return m_lastCompleted;
+}
+
+bool FenceTimeline::Wait(UINT64 value, DWORD timeout)
+{
+  // タイムアウトした待機のイベントが後から届くことがあるので, 起きたら値を確かめ直す.
+  auto deadline = GetTickCount64() + timeout;
+  while (!IsComplete(value)) {
+    DWORD remain = INFINITE;
+    if (timeout != INFINITE) {
+      auto now = GetTickCount64();
+      if (now >= deadline) {
+        return false;
+      }
+      remain = DWORD(deadline - now);
+    }
+    HRESULT hr = m_fence->SetEventOnCompletion(value, m_waitEvent);
+    ThrowIfFailed(hr, "SetEventOnCompletion 失敗");
+    if (WaitForSingleObject(m_waitEvent, remain) != WAIT_OBJECT_0) {
+      return IsComplete(value);
+    }
+  }
+  return true;
+}
+
+void FenceTimeline::WaitOnQueue(ID3D12CommandQueue* queue, UINT64 value) const
+{
+  if (!IsComplete(value)) {
+    queue->Wait(m_fence.Get(), value);
+  }
+}
@@ -0,0 +1,42 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+
+#include "D3D12BookUtil.h"
+
+// 1 つのコマンドキューに対応するタイムラインフェンス.
+// Signal の度に値が単調に増えるので, フェンス値を比べるだけで完了を判定できる.
+// フレームの同期, アップロード, 遅延解放で共有する. メインスレッドから使用すること.
+class FenceTimeline
+{
+public:
+  template<class T>
+  using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+  FenceTimeline(ComPtr<ID3D12Device> device, ComPtr<ID3D12CommandQueue> queue);
+  ~FenceTimeline();
+
+  // キューにシグナルを積み, GPU がそこへ到達した時に完了となる値を返す.
+  UINT64 Signal();
+
+  bool IsComplete(UINT64 value) const;
+  UINT64 GetCompletedValue() const;
+  UINT64 GetLastSignaledValue() const { return m_lastSignaled; }
+
+  // value の完了をイベントで待つ. タイムアウトした場合は false を返す.
+  bool Wait(UINT64 value, DWORD timeout = INFINITE);
+  // これまでに積んだコマンドの完了を待つ.
+  bool WaitIdle(DWORD timeout = INFINITE) { return Wait(Signal(), timeout); }
+
+  // 別のキューに value の完了を GPU 側で待たせる. CPU はブロックしない.
+  void WaitOnQueue(ID3D12CommandQueue* queue, UINT64 value) const;
+
+  ID3D12CommandQueue* GetQueue() const { return m_queue.Get(); }
+  ID3D12Fence* GetFence() const { return m_fence.Get(); }
+private:
+  ComPtr<ID3D12CommandQueue> m_queue;
+  ComPtr<ID3D12Fence> m_fence;
+  UINT64 m_lastSignaled;
+  mutable UINT64 m_lastCompleted;  // GetCompletedValue の呼び出しを減らすためのキャッシュ.
+  HANDLE m_waitEvent;
+};
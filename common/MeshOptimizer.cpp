@@ -0,0 +1,440 @@
+#include "MeshOptimizer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+#include <cassert>
+#include <cstring>
+#include <atomic>
+#include <execution>
+
+using namespace DirectX;
+
+namespace {
+  const uint32_t InvalidIndex = ~0u;
+
+  // Forsyth 法のパラメータ.
+  const int   MaxCacheSize = 32;
+  const float CacheDecayPower = 1.5f;
+  const float LastTriScore = 0.75f;
+  const float ValenceBoostScale = 2.0f;
+  const float ValenceBoostPower = 0.5f;
+  const int   MaxValence = 64;
+
+  struct ScoreTable {
+    float cache[MaxCacheSize];
+    float valence[MaxValence];
+
+    ScoreTable() {
+      for (int i = 0; i < MaxCacheSize; ++i) {
+        if (i < 3) {
+          // 直前の三角形で使った頂点は少し下げて、同じ辺ばかり辿らないようにする.
+          cache[i] = LastTriScore;
+        } else {
+          const float scaler = 1.0f / (MaxCacheSize - 3);
+          cache[i] = std::pow(1.0f - (i - 3) * scaler, CacheDecayPower);
+        }
+      }
+      valence[0] = 0.0f;
+      for (int i = 1; i < MaxValence; ++i) {
+        valence[i] = ValenceBoostScale * std::pow(float(i), -ValenceBoostPower);
+      }
+    }
+  };
+
+  float GetVertexScore(const ScoreTable& table, int cachePosition, uint32_t remainingValence) {
+    if (remainingValence == 0) {
+      return -1.0f;
+    }
+    float score = 0.0f;
+    if (cachePosition >= 0) {
+      score = table.cache[cachePosition];
+    }
+    score += table.valence[std::min<uint32_t>(remainingValence, MaxValence - 1)];
+    return score;
+  }
+
+  // 頂点ごとに参照している三角形の一覧.
+  struct TriangleAdjacency {
+    std::vector<uint32_t> counts;
+    std::vector<uint32_t> offsets;
+    std::vector<uint32_t> triangles;
+
+    void Build(const uint32_t* indices, size_t indexCount, uint32_t vertexCount) {
+      counts.assign(vertexCount, 0);
+      offsets.assign(vertexCount, 0);
+      triangles.resize(indexCount);
+      for (size_t i = 0; i < indexCount; ++i) {
+        counts[indices[i]]++;
+      }
+      uint32_t offset = 0;
+      for (uint32_t v = 0; v < vertexCount; ++v) {
+        offsets[v] = offset;
+        offset += counts[v];
+      }
+      std::vector<uint32_t> fill(offsets);
+      for (size_t i = 0; i < indexCount; ++i) {
+        triangles[fill[indices[i]]++] = uint32_t(i / 3);
+      }
+    }
+  };
+
+  // FIFO キャッシュを模擬し、指定範囲の三角形のキャッシュミス数を返す.
+  class FifoCache {
+  public:
+    FifoCache(uint32_t vertexCount, uint32_t cacheSize)
+      : m_timestamps(vertexCount, 0), m_time(cacheSize + 1), m_cacheSize(cacheSize) { }
+
+    uint32_t Touch(const uint32_t* tri) {
+      uint32_t misses = 0;
+      for (int k = 0; k < 3; ++k) {
+        auto v = tri[k];
+        if (m_time - m_timestamps[v] > m_cacheSize) {
+          m_timestamps[v] = m_time++;
+          misses++;
+        }
+      }
+      return misses;
+    }
+    void Reset() {
+      m_time += m_cacheSize + 1;
+    }
+  private:
+    std::vector<uint32_t> m_timestamps;
+    uint32_t m_time;
+    uint32_t m_cacheSize;
+  };
+
+  // 頂点溶接用のハッシュ (FNV-1a 64bit). 全ストリームのバイト列を対象とする.
+  uint64_t HashVertex(const mesh_optimizer::VertexStream* streams, size_t streamCount, uint32_t index) {
+    uint64_t hash = 14695981039346656037ull;
+    for (size_t s = 0; s < streamCount; ++s) {
+      auto bytes = static_cast<const uint8_t*>(streams[s].data) + streams[s].stride * index;
+      for (size_t i = 0; i < streams[s].stride; ++i) {
+        hash = (hash ^ bytes[i]) * 1099511628211ull;
+      }
+    }
+    return hash;
+  }
+
+  bool IsSameVertex(const mesh_optimizer::VertexStream* streams, size_t streamCount, uint32_t a, uint32_t b) {
+    for (size_t s = 0; s < streamCount; ++s) {
+      auto bytes = static_cast<const uint8_t*>(streams[s].data);
+      auto stride = streams[s].stride;
+      if (memcmp(bytes + stride * a, bytes + stride * b, stride) != 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+}
+
+namespace mesh_optimizer {
+  VertexCacheStats AnalyzeVertexCache(const uint32_t* indices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize) {
+    VertexCacheStats stats;
+    stats.triangleCount = uint32_t(indexCount / 3);
+
+    std::vector<bool> referenced(vertexCount, false);
+    for (size_t i = 0; i < indexCount; ++i) {
+      if (!referenced[indices[i]]) {
+        referenced[indices[i]] = true;
+        stats.vertexCount++;
+      }
+    }
+
+    FifoCache cache(vertexCount, cacheSize);
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+      stats.cacheMisses += cache.Touch(indices + i);
+    }
+    return stats;
+  }
+
+  void OptimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexCount) {
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount == 0) {
+      return;
+    }
+    static const ScoreTable table;
+
+    TriangleAdjacency adjacency;
+    adjacency.Build(indices, triangleCount * 3, vertexCount);
+
+    std::vector<uint32_t> remainingValence(adjacency.counts);
+    std::vector<float> vertexScore(vertexCount);
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+      vertexScore[v] = GetVertexScore(table, -1, remainingValence[v]);
+    }
+
+    std::vector<float> triangleScore(triangleCount);
+    std::vector<bool> emitted(triangleCount, false);
+    for (size_t t = 0; t < triangleCount; ++t) {
+      const auto* tri = indices + t * 3;
+      triangleScore[t] = vertexScore[tri[0]] + vertexScore[tri[1]] + vertexScore[tri[2]];
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(triangleCount * 3);
+
+    // キャッシュは 3 頂点分の余裕を持たせ、押し出された頂点のスコアも更新する.
+    uint32_t cache[MaxCacheSize + 3];
+    int cacheCount = 0;
+
+    size_t scanCursor = 0;
+    uint32_t bestTriangle = InvalidIndex;
+    float bestScore = -1.0f;
+    for (size_t t = 0; t < triangleCount; ++t) {
+      if (triangleScore[t] > bestScore) {
+        bestScore = triangleScore[t];
+        bestTriangle = uint32_t(t);
+      }
+    }
+
+    while (bestTriangle != InvalidIndex) {
+      const uint32_t* tri = indices + size_t(bestTriangle) * 3;
+      result.insert(result.end(), tri, tri + 3);
+      emitted[bestTriangle] = true;
+
+      // 出力した三角形を隣接リストから取り除く.
+      for (int k = 0; k < 3; ++k) {
+        auto v = tri[k];
+        auto* list = adjacency.triangles.data() + adjacency.offsets[v];
+        auto count = remainingValence[v];
+        for (uint32_t j = 0; j < count; ++j) {
+          if (list[j] == bestTriangle) {
+            std::swap(list[j], list[count - 1]);
+            break;
+          }
+        }
+        remainingValence[v]--;
+      }
+
+      // LRU キャッシュの更新. 出力した頂点を先頭へ.
+      uint32_t newCache[MaxCacheSize + 3];
+      int newCount = 0;
+      for (int k = 0; k < 3; ++k) {
+        newCache[newCount++] = tri[k];
+      }
+      for (int i = 0; i < cacheCount; ++i) {
+        auto v = cache[i];
+        if (v != tri[0] && v != tri[1] && v != tri[2]) {
+          newCache[newCount++] = v;
+        }
+      }
+      // キャッシュ内頂点のスコアと、それに接続する三角形のスコアを更新.
+      bestTriangle = InvalidIndex;
+      bestScore = -1.0f;
+      for (int i = 0; i < newCount; ++i) {
+        auto v = newCache[i];
+        int position = i < MaxCacheSize ? i : -1;
+        float score = GetVertexScore(table, position, remainingValence[v]);
+        float diff = score - vertexScore[v];
+        vertexScore[v] = score;
+
+        const auto* list = adjacency.triangles.data() + adjacency.offsets[v];
+        for (uint32_t j = 0; j < remainingValence[v]; ++j) {
+          auto t = list[j];
+          triangleScore[t] += diff;
+          if (triangleScore[t] > bestScore) {
+            bestScore = triangleScore[t];
+            bestTriangle = t;
+          }
+        }
+      }
+      cacheCount = std::min(newCount, MaxCacheSize);
+      std::copy(newCache, newCache + cacheCount, cache);
+
+      // キャッシュに候補がなければ未出力の三角形を先頭から探す.
+      if (bestTriangle == InvalidIndex) {
+        while (scanCursor < triangleCount && emitted[scanCursor]) {
+          ++scanCursor;
+        }
+        if (scanCursor < triangleCount) {
+          bestTriangle = uint32_t(scanCursor);
+        }
+      }
+    }
+    assert(result.size() == triangleCount * 3);
+    std::copy(result.begin(), result.end(), indices);
+  }
+
+  void OptimizeOverdraw(
+    uint32_t* indices, size_t indexCount,
+    const XMFLOAT3* positions, uint32_t vertexCount, float threshold) {
+    const size_t triangleCount = indexCount / 3;
+    if (triangleCount < 2) {
+      return;
+    }
+    const uint32_t cacheSize = 16;
+
+    // キャッシュは頂点数分の配列を持つので 1 つだけ作り, Reset で使い回す.
+    FifoCache cache(vertexCount, cacheSize);
+
+    // キャッシュを使い切った位置をクラスタの境界とする.
+    std::vector<uint32_t> hardClusters;
+    for (size_t t = 0; t < triangleCount; ++t) {
+      if (cache.Touch(indices + t * 3) == 3 || t == 0) {
+        hardClusters.push_back(uint32_t(t));
+      }
+    }
+
+    // キャッシュ効率の劣化が threshold に収まる範囲でクラスタを細分化.
+    std::vector<uint32_t> clusters;
+    for (size_t c = 0; c < hardClusters.size(); ++c) {
+      uint32_t start = hardClusters[c];
+      uint32_t end = c + 1 < hardClusters.size() ? hardClusters[c + 1] : uint32_t(triangleCount);
+
+      cache.Reset();
+      uint32_t clusterMisses = 0;
+      for (uint32_t t = start; t < end; ++t) {
+        clusterMisses += cache.Touch(indices + t * 3);
+      }
+      float clusterThreshold = threshold * float(clusterMisses) / float(end - start);
+
+      clusters.push_back(start);
+      cache.Reset();
+      uint32_t runningMisses = 0, runningTriangles = 0;
+      for (uint32_t t = start; t < end; ++t) {
+        runningMisses += cache.Touch(indices + t * 3);
+        runningTriangles++;
+        if (t + 1 < end && float(runningMisses) / runningTriangles <= clusterThreshold) {
+          clusters.push_back(t + 1);
+          cache.Reset();
+          runningMisses = 0;
+          runningTriangles = 0;
+        }
+      }
+    }
+
+    // メッシュ全体の重心.
+    XMVECTOR meshCentroid = XMVectorZero();
+    for (size_t i = 0; i < indexCount; ++i) {
+      meshCentroid += XMLoadFloat3(&positions[indices[i]]);
+    }
+    meshCentroid /= float(triangleCount * 3);
+
+    // 外側を向いているクラスタほど先に描画する.
+    struct ClusterSort {
+      uint32_t start, end;
+      float key;
+    };
+    std::vector<ClusterSort> sorted(clusters.size());
+    for (size_t c = 0; c < clusters.size(); ++c) {
+      uint32_t start = clusters[c];
+      uint32_t end = c + 1 < clusters.size() ? clusters[c + 1] : uint32_t(triangleCount);
+
+      XMVECTOR centroid = XMVectorZero();
+      XMVECTOR normal = XMVectorZero();
+      float area = 0.0f;
+      for (uint32_t t = start; t < end; ++t) {
+        auto p0 = XMLoadFloat3(&positions[indices[t * 3 + 0]]);
+        auto p1 = XMLoadFloat3(&positions[indices[t * 3 + 1]]);
+        auto p2 = XMLoadFloat3(&positions[indices[t * 3 + 2]]);
+        auto n = XMVector3Cross(p1 - p0, p2 - p0);
+        float a = XMVectorGetX(XMVector3Length(n));
+        centroid += (p0 + p1 + p2) * (a / 3.0f);
+        normal += n;
+        area += a;
+      }
+      float key = 0.0f;
+      if (area > 0.0f) {
+        centroid /= area;
+        key = XMVectorGetX(XMVector3Dot(centroid - meshCentroid, XMVector3Normalize(normal)));
+      }
+      sorted[c] = { start, end, key };
+    }
+    std::stable_sort(sorted.begin(), sorted.end(),
+      [](const ClusterSort& a, const ClusterSort& b) { return a.key > b.key; });
+
+    std::vector<uint32_t> result;
+    result.reserve(triangleCount * 3);
+    for (const auto& c : sorted) {
+      result.insert(result.end(), indices + c.start * 3, indices + c.end * 3);
+    }
+    std::copy(result.begin(), result.end(), indices);
+  }
+
+  std::vector<uint32_t> OptimizeVertexFetchRemap(uint32_t* indices, size_t indexCount, uint32_t vertexCount) {
+    std::vector<uint32_t> remap(vertexCount, InvalidIndex);
+    uint32_t next = 0;
+    for (size_t i = 0; i < indexCount; ++i) {
+      auto& index = indices[i];
+      if (remap[index] == InvalidIndex) {
+        remap[index] = next++;
+      }
+      index = remap[index];
+    }
+    for (auto& r : remap) {
+      if (r == InvalidIndex) {
+        r = next++;
+      }
+    }
+    return remap;
+  }
+
+  std::vector<uint32_t> GenerateWeldRemap(
+    const VertexStream* streams, size_t streamCount, uint32_t vertexCount, uint32_t& uniqueCount) {
+    std::vector<uint32_t> vertices(vertexCount);
+    std::iota(vertices.begin(), vertices.end(), 0u);
+    std::vector<uint64_t> hashes(vertexCount);
+    std::for_each(std::execution::par, vertices.begin(), vertices.end(), [&](uint32_t i) {
+      hashes[i] = HashVertex(streams, streamCount, i);
+    });
+
+    // 開番地法のハッシュ表. スロットには同じ頂点のうち最小の番号が CAS で残る.
+    size_t tableSize = 1;
+    while (tableSize < size_t(vertexCount) * 2) {
+      tableSize <<= 1;
+    }
+    const size_t mask = tableSize - 1;
+    std::vector<std::atomic<uint32_t>> table(tableSize);
+    for (auto& entry : table) {
+      entry.store(InvalidIndex, std::memory_order_relaxed);
+    }
+
+    auto isSame = [&](uint32_t a, uint32_t b) {
+      return hashes[a] == hashes[b] && IsSameVertex(streams, streamCount, a, b);
+    };
+    std::for_each(std::execution::par, vertices.begin(), vertices.end(), [&](uint32_t i) {
+      size_t slot = size_t(hashes[i]) & mask;
+      for (;;) {
+        auto& entry = table[slot];
+        auto current = entry.load();
+        if (current == InvalidIndex) {
+          if (entry.compare_exchange_weak(current, i)) {
+            return;
+          }
+          continue;
+        }
+        if (isSame(current, i)) {
+          // スロットの値は同じ頂点同士でしか入れ替わらないので, 小さい番号になるまで試す.
+          while (i < current && !entry.compare_exchange_weak(current, i)) {
+          }
+          return;
+        }
+        slot = (slot + 1) & mask;
+      }
+    });
+
+    // 登録が終わった表から各頂点の代表を引く.
+    std::vector<uint32_t> representative(vertexCount);
+    std::for_each(std::execution::par, vertices.begin(), vertices.end(), [&](uint32_t i) {
+      size_t slot = size_t(hashes[i]) & mask;
+      for (;;) {
+        auto current = table[slot].load(std::memory_order_relaxed);
+        if (isSame(current, i)) {
+          representative[i] = current;
+          return;
+        }
+        slot = (slot + 1) & mask;
+      }
+    });
+
+    // 代表は常に自分以下の番号なので, 前から順に新番号を振れる.
+    std::vector<uint32_t> remap(vertexCount);
+    uniqueCount = 0;
+    for (uint32_t i = 0; i < vertexCount; ++i) {
+      remap[i] = (representative[i] == i) ? uniqueCount++ : remap[representative[i]];
+    }
+    return remap;
+  }
+}
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+
+// インデックスバッファの並び替えによる頂点キャッシュ/オーバードローの最適化.
+// インデックスはバッチ(メッシュ)ローカルの頂点番号を前提とする.
+namespace mesh_optimizer {
+  struct VertexCacheStats {
+    uint32_t triangleCount = 0;
+    uint32_t vertexCount = 0;   // 参照されている頂点数.
+    uint32_t cacheMisses = 0;
+
+    // Average Cache Miss Ratio (三角形あたりの頂点シェーダー実行数).
+    float GetACMR() const { return triangleCount ? float(cacheMisses) / triangleCount : 0.0f; }
+    // Average Transform to Vertex Ratio (頂点あたりの頂点シェーダー実行数).
+    float GetATVR() const { return vertexCount ? float(cacheMisses) / vertexCount : 0.0f; }
+
+    VertexCacheStats& operator+=(const VertexCacheStats& rhs) {
+      triangleCount += rhs.triangleCount;
+      vertexCount += rhs.vertexCount;
+      cacheMisses += rhs.cacheMisses;
+      return *this;
+    }
+  };
+
+  // FIFO キャッシュを模擬してキャッシュミス数を計測.
+  VertexCacheStats AnalyzeVertexCache(
+    const uint32_t* indices, size_t indexCount, uint32_t vertexCount, uint32_t cacheSize = 16);
+
+  // Forsyth 法による頂点キャッシュ向けの三角形並び替え.
+  void OptimizeVertexCache(uint32_t* indices, size_t indexCount, uint32_t vertexCount);
+
+  // キャッシュ効率を threshold 倍まで許容してクラスタ単位で外向きの面を先に描く順へ並び替え.
+  // OptimizeVertexCache の後に呼び出す.
+  void OptimizeOverdraw(
+    uint32_t* indices, size_t indexCount,
+    const DirectX::XMFLOAT3* positions, uint32_t vertexCount, float threshold = 1.05f);
+
+  // 頂点を最初に参照される順に並べ替えるための対応表を作成し、インデックスを書き換える.
+  // 戻り値は remap[旧番号] = 新番号. 参照されない頂点は末尾へ詰める.
+  std::vector<uint32_t> OptimizeVertexFetchRemap(uint32_t* indices, size_t indexCount, uint32_t vertexCount);
+
+  // 溶接の比較対象となる頂点ストリーム. 頂点 i の要素は data + stride * i.
+  struct VertexStream {
+    const void* data;
+    size_t stride;
+  };
+
+  // 全ストリームのバイト列が一致する頂点を 1 つにまとめる対応表を作成する.
+  // 戻り値は remap[旧番号] = 新番号で, 新番号は残る頂点が最初に現れた順. uniqueCount に残る頂点数を返す.
+  // ハッシュ表への登録は並列に行い, 重複の代表は常に最小の番号になる.
+  std::vector<uint32_t> GenerateWeldRemap(
+    const VertexStream* streams, size_t streamCount, uint32_t vertexCount, uint32_t& uniqueCount);
+
+  // remap に従って頂点を詰める. 同じ新番号を持つ頂点は同一なのでどれを書いてもよい.
+  template<class T>
+  std::vector<T> CompactVertexStream(const std::vector<T>& vertices, const std::vector<uint32_t>& remap, uint32_t uniqueCount) {
+    std::vector<T> result(uniqueCount);
+    for (size_t i = 0; i < remap.size(); ++i) {
+      result[remap[i]] = vertices[i];
+    }
+    return result;
+  }
+
+  template<class T>
+  void RemapVertexStream(T* vertices, const std::vector<uint32_t>& remap) {
+    std::vector<T> work(vertices, vertices + remap.size());
+    for (size_t i = 0; i < remap.size(); ++i) {
+      vertices[remap[i]] = work[i];
+    }
+  }
+}
@@ -0,0 +1,341 @@
+#include "MeshSimplifier.h"
+
+#include <algorithm>
+#include <queue>
+#include <unordered_map>
+#include <cmath>
+#include <cstring>
+#include <cfloat>
+
+using namespace DirectX;
+
+namespace {
+  // ボーンウェイトの差 (0..2) に掛けるメッシュ半径比のペナルティ.
+  const float SkinWeightPenalty = 0.05f;
+
+  // 対称 4x4 行列を上三角の 10 要素で保持.
+  // 重みの合計も持ち, 平面までの距離の二乗を重み付き平均で返す (単位は長さの二乗).
+  struct Quadric {
+    double a00 = 0, a01 = 0, a02 = 0, a03 = 0;
+    double a11 = 0, a12 = 0, a13 = 0;
+    double a22 = 0, a23 = 0;
+    double a33 = 0;
+    double weight = 0;
+
+    void AddPlane(double a, double b, double c, double d, double w) {
+      a00 += w * a * a; a01 += w * a * b; a02 += w * a * c; a03 += w * a * d;
+      a11 += w * b * b; a12 += w * b * c; a13 += w * b * d;
+      a22 += w * c * c; a23 += w * c * d;
+      a33 += w * d * d;
+      weight += w;
+    }
+    Quadric& operator+=(const Quadric& q) {
+      a00 += q.a00; a01 += q.a01; a02 += q.a02; a03 += q.a03;
+      a11 += q.a11; a12 += q.a12; a13 += q.a13;
+      a22 += q.a22; a23 += q.a23;
+      a33 += q.a33;
+      weight += q.weight;
+      return *this;
+    }
+    double Evaluate(const XMFLOAT3& p) const {
+      if (weight <= 0.0) {
+        return 0.0;
+      }
+      double x = p.x, y = p.y, z = p.z;
+      double r = a00 * x * x + a11 * y * y + a22 * z * z
+        + 2.0 * (a01 * x * y + a02 * x * z + a12 * y * z)
+        + 2.0 * (a03 * x + a13 * y + a23 * z)
+        + a33;
+      return std::max(r / weight, 0.0);
+    }
+  };
+
+  struct Collapse {
+    double cost;
+    uint32_t from, to;
+    uint32_t versionFrom, versionTo;
+
+    bool operator>(const Collapse& rhs) const { return cost > rhs.cost; }
+  };
+
+  uint64_t MakeEdgeKey(uint32_t a, uint32_t b) {
+    return (uint64_t(a) << 32) | b;
+  }
+
+  struct PositionHash {
+    size_t operator()(const XMFLOAT3& p) const {
+      uint32_t h[3];
+      memcpy(h, &p, sizeof(h));
+      return size_t(h[0] * 73856093u ^ h[1] * 19349663u ^ h[2] * 83492791u);
+    }
+  };
+  struct PositionEqual {
+    bool operator()(const XMFLOAT3& a, const XMFLOAT3& b) const {
+      return a.x == b.x && a.y == b.y && a.z == b.z;
+    }
+  };
+
+  // 2 頂点のボーンウェイト分布の差 (L1 距離).
+  float GetSkinWeightDifference(const mesh_optimizer::SimplifyVertexInput& v, uint32_t a, uint32_t b) {
+    if (v.boneIndices == nullptr || v.boneWeights == nullptr) {
+      return 0.0f;
+    }
+    const int32_t ia[4] = { v.boneIndices[a].x, v.boneIndices[a].y, v.boneIndices[a].z, v.boneIndices[a].w };
+    const int32_t ib[4] = { v.boneIndices[b].x, v.boneIndices[b].y, v.boneIndices[b].z, v.boneIndices[b].w };
+    const float wa[4] = { v.boneWeights[a].x, v.boneWeights[a].y, v.boneWeights[a].z, v.boneWeights[a].w };
+    const float wb[4] = { v.boneWeights[b].x, v.boneWeights[b].y, v.boneWeights[b].z, v.boneWeights[b].w };
+
+    float diff = 0.0f;
+    for (int i = 0; i < 4; ++i) {
+      float other = 0.0f;
+      for (int j = 0; j < 4; ++j) {
+        if (ib[j] == ia[i]) {
+          other += wb[j];
+        }
+      }
+      diff += std::abs(wa[i] - other);
+    }
+    for (int j = 0; j < 4; ++j) {
+      bool found = false;
+      for (int i = 0; i < 4; ++i) {
+        found |= (ia[i] == ib[j]);
+      }
+      if (!found) {
+        diff += wb[j];
+      }
+    }
+    return diff;
+  }
+
+  XMVECTOR GetTriangleNormal(const XMFLOAT3* positions, uint32_t i0, uint32_t i1, uint32_t i2) {
+    auto p0 = XMLoadFloat3(&positions[i0]);
+    auto p1 = XMLoadFloat3(&positions[i1]);
+    auto p2 = XMLoadFloat3(&positions[i2]);
+    return XMVector3Cross(p1 - p0, p2 - p0);
+  }
+}
+
+namespace mesh_optimizer {
+  float ComputeMeshRadius(const uint32_t* indices, size_t indexCount, const XMFLOAT3* positions) {
+    if (indexCount == 0) {
+      return 0.0f;
+    }
+    XMVECTOR bbMin = XMVectorReplicate(FLT_MAX), bbMax = XMVectorReplicate(-FLT_MAX);
+    for (size_t i = 0; i < indexCount; ++i) {
+      auto p = XMLoadFloat3(&positions[indices[i]]);
+      bbMin = XMVectorMin(bbMin, p);
+      bbMax = XMVectorMax(bbMax, p);
+    }
+    return XMVectorGetX(XMVector3Length(bbMax - bbMin)) * 0.5f;
+  }
+
+  std::vector<uint32_t> SimplifyMesh(
+    const uint32_t* indices, size_t indexCount,
+    const SimplifyVertexInput& vertices,
+    size_t targetIndexCount, float targetError, float* resultError) {
+    const auto* positions = vertices.positions;
+    const uint32_t vertexCount = vertices.vertexCount;
+    const size_t triangleCount = indexCount / 3;
+    std::vector<uint32_t> triangles(indices, indices + triangleCount * 3);
+    if (resultError) {
+      *resultError = 0.0f;
+    }
+    if (triangleCount * 3 <= targetIndexCount) {
+      return triangles;
+    }
+
+    const float radius = std::max(ComputeMeshRadius(indices, indexCount, positions), 1.0e-6f);
+    const double maxCost = double(targetError) * radius * double(targetError) * radius;
+    const double skinScale = double(SkinWeightPenalty) * radius;
+
+    // 同じ位置を共有する頂点をまとめ, 継ぎ目を判定する.
+    std::vector<uint32_t> positionGroup(vertexCount);
+    std::vector<uint32_t> groupSize(vertexCount, 0);
+    {
+      std::unordered_map<XMFLOAT3, uint32_t, PositionHash, PositionEqual> positionMap;
+      for (uint32_t v = 0; v < vertexCount; ++v) {
+        auto result = positionMap.emplace(positions[v], v);
+        positionGroup[v] = result.first->second;
+      }
+      for (size_t i = 0; i < triangleCount * 3; ++i) {
+        // 参照されている頂点だけを数える.
+        auto v = triangles[i];
+        if (groupSize[v] == 0) {
+          groupSize[v] = 1;
+        }
+      }
+      std::vector<uint32_t> referenced(groupSize);
+      std::fill(groupSize.begin(), groupSize.end(), 0);
+      for (uint32_t v = 0; v < vertexCount; ++v) {
+        if (referenced[v]) {
+          groupSize[positionGroup[v]]++;
+        }
+      }
+    }
+
+    // 向かい合う辺が存在しない辺を境界とする.
+    std::vector<bool> locked(vertexCount, false);
+    {
+      std::unordered_map<uint64_t, uint32_t> directedEdges;
+      directedEdges.reserve(triangleCount * 3);
+      for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+          auto a = positionGroup[triangles[t * 3 + k]];
+          auto b = positionGroup[triangles[t * 3 + (k + 1) % 3]];
+          directedEdges[MakeEdgeKey(a, b)]++;
+        }
+      }
+      for (size_t t = 0; t < triangleCount; ++t) {
+        for (int k = 0; k < 3; ++k) {
+          auto va = triangles[t * 3 + k];
+          auto vb = triangles[t * 3 + (k + 1) % 3];
+          auto a = positionGroup[va];
+          auto b = positionGroup[vb];
+          if (directedEdges.find(MakeEdgeKey(b, a)) == directedEdges.end()) {
+            locked[va] = true;
+            locked[vb] = true;
+          }
+        }
+      }
+      for (uint32_t v = 0; v < vertexCount; ++v) {
+        if (groupSize[positionGroup[v]] > 1) {
+          locked[v] = true;
+        }
+      }
+    }
+
+    // 頂点ごとの Quadric と隣接三角形.
+    std::vector<Quadric> quadrics(vertexCount);
+    std::vector<std::vector<uint32_t>> vertexTriangles(vertexCount);
+    for (size_t t = 0; t < triangleCount; ++t) {
+      const auto* tri = triangles.data() + t * 3;
+      auto n = GetTriangleNormal(positions, tri[0], tri[1], tri[2]);
+      float area = XMVectorGetX(XMVector3Length(n));
+      if (area > 0.0f) {
+        n = n / area;
+        auto p0 = XMLoadFloat3(&positions[tri[0]]);
+        double d = -XMVectorGetX(XMVector3Dot(n, p0));
+        for (int k = 0; k < 3; ++k) {
+          quadrics[tri[k]].AddPlane(XMVectorGetX(n), XMVectorGetY(n), XMVectorGetZ(n), d, area * 0.5);
+        }
+      }
+      for (int k = 0; k < 3; ++k) {
+        vertexTriangles[tri[k]].push_back(uint32_t(t));
+      }
+    }
+
+    std::vector<bool> triangleAlive(triangleCount, true);
+    std::vector<bool> removed(vertexCount, false);
+    std::vector<uint32_t> version(vertexCount, 0);
+    std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> queue;
+
+    auto pushCollapse = [&](uint32_t from, uint32_t to) {
+      if (locked[from] || from == to) {
+        return;
+      }
+      Quadric q = quadrics[from];
+      q += quadrics[to];
+      double cost = q.Evaluate(positions[to]);
+      double skin = GetSkinWeightDifference(vertices, from, to) * skinScale;
+      cost += skin * skin;
+      queue.push({ cost, from, to, version[from], version[to] });
+    };
+    for (size_t t = 0; t < triangleCount; ++t) {
+      for (int k = 0; k < 3; ++k) {
+        auto a = triangles[t * 3 + k];
+        auto b = triangles[t * 3 + (k + 1) % 3];
+        pushCollapse(a, b);
+        pushCollapse(b, a);
+      }
+    }
+
+    size_t liveTriangles = triangleCount;
+    double acceptedCost = 0.0;
+    while (liveTriangles * 3 > targetIndexCount && !queue.empty()) {
+      auto c = queue.top();
+      queue.pop();
+      if (removed[c.from] || removed[c.to] ||
+        version[c.from] != c.versionFrom || version[c.to] != c.versionTo) {
+        continue;
+      }
+      if (c.cost > maxCost) {
+        break;
+      }
+
+      // 縮退で面が裏返る場合は行わない.
+      bool flipped = false;
+      for (auto t : vertexTriangles[c.from]) {
+        if (!triangleAlive[t]) {
+          continue;
+        }
+        const auto* tri = triangles.data() + size_t(t) * 3;
+        if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+          continue;
+        }
+        uint32_t after[3] = { tri[0], tri[1], tri[2] };
+        for (auto& v : after) {
+          if (v == c.from) {
+            v = c.to;
+          }
+        }
+        auto nBefore = GetTriangleNormal(positions, tri[0], tri[1], tri[2]);
+        auto nAfter = GetTriangleNormal(positions, after[0], after[1], after[2]);
+        if (XMVectorGetX(XMVector3Dot(nBefore, nAfter)) <= 0.0f) {
+          flipped = true;
+          break;
+        }
+      }
+      if (flipped) {
+        continue;
+      }
+
+      for (auto t : vertexTriangles[c.from]) {
+        if (!triangleAlive[t]) {
+          continue;
+        }
+        auto* tri = triangles.data() + size_t(t) * 3;
+        if (tri[0] == c.to || tri[1] == c.to || tri[2] == c.to) {
+          triangleAlive[t] = false;
+          liveTriangles--;
+          continue;
+        }
+        for (int k = 0; k < 3; ++k) {
+          if (tri[k] == c.from) {
+            tri[k] = c.to;
+          }
+        }
+        vertexTriangles[c.to].push_back(t);
+      }
+      vertexTriangles[c.from].clear();
+      removed[c.from] = true;
+      quadrics[c.to] += quadrics[c.from];
+      version[c.to]++;
+      acceptedCost = std::max(acceptedCost, c.cost);
+
+      // 縮退先に接続する辺のコストを更新.
+      auto& list = vertexTriangles[c.to];
+      list.erase(std::remove_if(list.begin(), list.end(), [&](uint32_t t) { return !triangleAlive[t]; }), list.end());
+      for (auto t : list) {
+        const auto* tri = triangles.data() + size_t(t) * 3;
+        for (int k = 0; k < 3; ++k) {
+          if (tri[k] != c.to) {
+            pushCollapse(tri[k], c.to);
+            pushCollapse(c.to, tri[k]);
+          }
+        }
+      }
+    }
+
+    std::vector<uint32_t> result;
+    result.reserve(liveTriangles * 3);
+    for (size_t t = 0; t < triangleCount; ++t) {
+      if (triangleAlive[t]) {
+        result.insert(result.end(), triangles.begin() + t * 3, triangles.begin() + t * 3 + 3);
+      }
+    }
+    if (resultError) {
+      *resultError = float(std::sqrt(acceptedCost)) / radius;
+    }
+    return result;
+  }
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+
+// Quadric Error Metrics による辺の縮退でメッシュを簡略化する.
+// 頂点は削除するだけで新規には作らないため, 既存の頂点バッファをそのまま LOD でも使える.
+namespace mesh_optimizer {
+  struct SimplifyVertexInput {
+    const DirectX::XMFLOAT3* positions = nullptr;
+    const DirectX::XMINT4*   boneIndices = nullptr;  // 省略可.
+    const DirectX::XMFLOAT4* boneWeights = nullptr;  // 省略可.
+    uint32_t vertexCount = 0;
+  };
+
+  // indices を targetIndexCount 以下になるまで簡略化し, 結果を返す.
+  // 誤差が targetError (メッシュ半径に対する相対値) を超える縮退は行わない.
+  // 同じ位置に複数の頂点がある箇所 (UV/法線の継ぎ目) と境界の頂点は固定し,
+  // ボーンウェイトが異なる頂点同士の縮退にはペナルティを加える.
+  std::vector<uint32_t> SimplifyMesh(
+    const uint32_t* indices, size_t indexCount,
+    const SimplifyVertexInput& vertices,
+    size_t targetIndexCount, float targetError, float* resultError = nullptr);
+
+  // 参照される頂点を包む球の半径. 誤差を相対値にする際の基準.
+  float ComputeMeshRadius(const uint32_t* indices, size_t indexCount, const DirectX::XMFLOAT3* positions);
+}
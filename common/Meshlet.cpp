@@ -0,0 +1,189 @@
+#include "Meshlet.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+
+using namespace DirectX;
+
+namespace {
+  const uint32_t InvalidIndex = ~0u;
+
+  void ComputeMeshletBounds(meshlet::Meshlet& m, const meshlet::MeshletData& data, const XMFLOAT3* positions) {
+    const auto* localVertices = data.vertices.data() + m.vertexOffset;
+    const auto* localTriangles = data.triangles.data() + m.triangleOffset;
+
+    // バウンディング球は AABB の中心から最も遠い頂点までで作る.
+    XMVECTOR bbMin = XMVectorReplicate(FLT_MAX), bbMax = XMVectorReplicate(-FLT_MAX);
+    for (uint32_t i = 0; i < m.vertexCount; ++i) {
+      auto p = XMLoadFloat3(&positions[localVertices[i]]);
+      bbMin = XMVectorMin(bbMin, p);
+      bbMax = XMVectorMax(bbMax, p);
+    }
+    auto center = (bbMin + bbMax) * 0.5f;
+    float radius = 0.0f;
+    for (uint32_t i = 0; i < m.vertexCount; ++i) {
+      auto p = XMLoadFloat3(&positions[localVertices[i]]);
+      radius = std::max(radius, XMVectorGetX(XMVector3Length(p - center)));
+    }
+    XMStoreFloat4(&m.boundingSphere, XMVectorSetW(center, radius));
+
+    // 法線コーン. 三角形の面法線 (反時計回りが表) の平均を軸とする.
+    std::vector<XMVECTOR> normals;
+    normals.reserve(m.triangleCount);
+    XMVECTOR axis = XMVectorZero();
+    for (uint32_t t = 0; t < m.triangleCount; ++t) {
+      auto p0 = XMLoadFloat3(&positions[localVertices[localTriangles[t * 3 + 0]]]);
+      auto p1 = XMLoadFloat3(&positions[localVertices[localTriangles[t * 3 + 1]]]);
+      auto p2 = XMLoadFloat3(&positions[localVertices[localTriangles[t * 3 + 2]]]);
+      auto n = XMVector3Cross(p1 - p0, p2 - p0);
+      if (XMVectorGetX(XMVector3LengthSq(n)) <= 0.0f) {
+        continue;
+      }
+      n = XMVector3Normalize(n);
+      normals.push_back(n);
+      axis += n;
+    }
+    m.coneApex = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+    m.coneAxis = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+    if (normals.empty() || XMVectorGetX(XMVector3LengthSq(axis)) <= 0.0f) {
+      return;
+    }
+    axis = XMVector3Normalize(axis);
+
+    float minDot = 1.0f;
+    for (auto& n : normals) {
+      minDot = std::min(minDot, XMVectorGetX(XMVector3Dot(n, axis)));
+    }
+    // 広がりが 90 度近いコーンではカリングできない.
+    if (minDot <= 0.1f) {
+      return;
+    }
+
+    // すべての三角形の平面より後ろに来るようにコーンの頂点を下げる.
+    float maxT = 0.0f;
+    for (uint32_t t = 0, ni = 0; t < m.triangleCount; ++t) {
+      auto p0 = XMLoadFloat3(&positions[localVertices[localTriangles[t * 3 + 0]]]);
+      auto p1 = XMLoadFloat3(&positions[localVertices[localTriangles[t * 3 + 1]]]);
+      auto p2 = XMLoadFloat3(&positions[localVertices[localTriangles[t * 3 + 2]]]);
+      auto n = XMVector3Cross(p1 - p0, p2 - p0);
+      if (XMVectorGetX(XMVector3LengthSq(n)) <= 0.0f) {
+        continue;
+      }
+      n = normals[ni++];
+      float dc = XMVectorGetX(XMVector3Dot(center - p0, n));
+      float dn = XMVectorGetX(XMVector3Dot(axis, n));
+      maxT = std::max(maxT, dc / dn);
+    }
+    XMStoreFloat4(&m.coneApex, center - axis * maxT);
+    XMStoreFloat4(&m.coneAxis, XMVectorSetW(axis, std::sqrt(1.0f - minDot * minDot)));
+  }
+}
+
+namespace meshlet {
+  void MeshletData::Append(const MeshletData& other) {
+    auto vertexBase = uint32_t(vertices.size());
+    auto triangleBase = uint32_t(triangles.size());
+    for (auto m : other.meshlets) {
+      m.vertexOffset += vertexBase;
+      m.triangleOffset += triangleBase;
+      meshlets.push_back(m);
+    }
+    vertices.insert(vertices.end(), other.vertices.begin(), other.vertices.end());
+    triangles.insert(triangles.end(), other.triangles.begin(), other.triangles.end());
+  }
+
+  void BuildMeshlets(
+    const uint32_t* indices, size_t indexCount,
+    const XMFLOAT3* positions, uint32_t vertexCount,
+    MeshletData& output,
+    uint32_t maxVertices, uint32_t maxTriangles) {
+    maxVertices = std::min<uint32_t>(maxVertices, 256);
+
+    std::vector<uint32_t> localIndex(vertexCount, InvalidIndex);
+    Meshlet current{};
+    current.vertexOffset = uint32_t(output.vertices.size());
+    current.triangleOffset = uint32_t(output.triangles.size());
+
+    auto flush = [&]() {
+      if (current.triangleCount == 0) {
+        return;
+      }
+      for (uint32_t i = 0; i < current.vertexCount; ++i) {
+        localIndex[output.vertices[current.vertexOffset + i]] = InvalidIndex;
+      }
+      ComputeMeshletBounds(current, output, positions);
+      output.meshlets.push_back(current);
+
+      current = Meshlet{};
+      current.vertexOffset = uint32_t(output.vertices.size());
+      current.triangleOffset = uint32_t(output.triangles.size());
+    };
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+      const uint32_t tri[3] = { indices[i], indices[i + 1], indices[i + 2] };
+      uint32_t newVertices = 0;
+      for (int k = 0; k < 3; ++k) {
+        if (localIndex[tri[k]] == InvalidIndex && (k == 0 || tri[k] != tri[0]) && (k < 2 || tri[k] != tri[1])) {
+          newVertices++;
+        }
+      }
+      if (current.vertexCount + newVertices > maxVertices || current.triangleCount + 1 > maxTriangles) {
+        flush();
+      }
+
+      for (int k = 0; k < 3; ++k) {
+        auto& local = localIndex[tri[k]];
+        if (local == InvalidIndex) {
+          local = current.vertexCount++;
+          output.vertices.push_back(tri[k]);
+        }
+        output.triangles.push_back(uint8_t(local));
+      }
+      current.triangleCount++;
+    }
+    flush();
+  }
+
+  bool IsMeshletVisible(const Meshlet& m, const CullingParameters& params) {
+    auto center = XMLoadFloat4(&m.boundingSphere);
+    float radius = m.boundingSphere.w;
+    center = XMVectorSetW(center, 1.0f);
+    for (const auto& plane : params.frustumPlanes) {
+      if (XMVectorGetX(XMVector4Dot(XMLoadFloat4(&plane), center)) < -radius) {
+        return false;
+      }
+    }
+
+    // カメラが法線コーンの裏側にあれば全ての三角形が裏向き.
+    if (m.coneAxis.w < 1.0f) {
+      auto apex = XMLoadFloat4(&m.coneApex);
+      auto axis = XMLoadFloat4(&m.coneAxis);
+      auto eye = XMLoadFloat3(&params.cameraPosition);
+      auto dir = XMVector3Normalize(apex - eye);
+      if (XMVectorGetX(XMVector3Dot(dir, axis)) >= m.coneAxis.w) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  uint32_t CullMeshlets(
+    const MeshletData& data, uint32_t firstMeshlet, uint32_t meshletCount,
+    const CullingParameters& params, std::vector<uint32_t>& outIndices) {
+    uint32_t visibleCount = 0;
+    for (uint32_t i = firstMeshlet; i < firstMeshlet + meshletCount; ++i) {
+      const auto& m = data.meshlets[i];
+      if (!IsMeshletVisible(m, params)) {
+        continue;
+      }
+      const auto* localVertices = data.vertices.data() + m.vertexOffset;
+      const auto* localTriangles = data.triangles.data() + m.triangleOffset;
+      for (uint32_t j = 0; j < m.triangleCount * 3; ++j) {
+        outIndices.push_back(localVertices[localTriangles[j]]);
+      }
+      visibleCount++;
+    }
+    return visibleCount;
+  }
+}
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+
+// 頂点数/三角形数を制限した小さなクラスタ (メッシュレット) の生成とカリング.
+namespace meshlet {
+  const uint32_t MaxMeshletVertices = 64;
+  const uint32_t MaxMeshletTriangles = 124;
+
+  struct Meshlet {
+    uint32_t vertexOffset;    // MeshletData::vertices 内の開始位置.
+    uint32_t vertexCount;
+    uint32_t triangleOffset;  // MeshletData::triangles 内の開始位置 (バイト単位).
+    uint32_t triangleCount;
+
+    DirectX::XMFLOAT4 boundingSphere; // xyz: 中心, w: 半径.
+    DirectX::XMFLOAT4 coneApex;       // xyz: 法線コーンの頂点.
+    DirectX::XMFLOAT4 coneAxis;       // xyz: 軸, w: カットオフ (1 以上なら裏面カリング不可).
+  };
+
+  struct MeshletData {
+    std::vector<Meshlet>  meshlets;
+    std::vector<uint32_t> vertices;   // バッチローカルの頂点番号.
+    std::vector<uint8_t>  triangles;  // メッシュレット内の頂点番号 3 つで 1 三角形.
+
+    void Append(const MeshletData& other);
+  };
+
+  // インデックスの並び順に沿ってメッシュレットへ分割し, バウンディング球と法線コーンを計算.
+  // 頂点キャッシュ最適化済みのインデックスを渡すと局所性の高いクラスタになる.
+  void BuildMeshlets(
+    const uint32_t* indices, size_t indexCount,
+    const DirectX::XMFLOAT3* positions, uint32_t vertexCount,
+    MeshletData& output,
+    uint32_t maxVertices = MaxMeshletVertices, uint32_t maxTriangles = MaxMeshletTriangles);
+
+  struct CullingParameters {
+    DirectX::XMFLOAT4 frustumPlanes[6];  // 内側が正となる平面.
+    DirectX::XMFLOAT3 cameraPosition;
+  };
+
+  bool IsMeshletVisible(const Meshlet& m, const CullingParameters& params);
+
+  // 可視なメッシュレットの三角形をインデックス列として outIndices に追記する.
+  // 戻り値は可視判定されたメッシュレットの数.
+  uint32_t CullMeshlets(
+    const MeshletData& data, uint32_t firstMeshlet, uint32_t meshletCount,
+    const CullingParameters& params, std::vector<uint32_t>& outIndices);
+}
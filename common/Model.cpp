@@ -1,433 +1,1525 @@
-#include "Model.h"
-
-#include <DirectXTex.h>
-#include <fstream>
-#include <stack>
-
-#include <assimp/Importer.hpp>
-#include <assimp/scene.h>
-#include <assimp/postprocess.h>
-
-using namespace DirectX;
-namespace fs = std::filesystem;
-
-namespace {
-  std::string ConvertFromUTF8(const char* utf8Str)
-  {
-    DWORD dwRet = MultiByteToWideChar(CP_UTF8, 0, utf8Str, -1, NULL, 0);
-    std::vector<wchar_t> wstrbuf;
-    wstrbuf.resize(dwRet);
-
-    MultiByteToWideChar(CP_UTF8, 0, utf8Str, -1, wstrbuf.data(), int(wstrbuf.size()));
-
-    dwRet = WideCharToMultiByte(932, 0, wstrbuf.data(), -1, NULL, 0, NULL, NULL);
-    std::vector<char> strbuf;
-    strbuf.resize(dwRet);
-
-    WideCharToMultiByte(932, 0, wstrbuf.data(), -1, strbuf.data(), int(strbuf.size()), NULL, NULL);
-    return std::string(strbuf.data());
-  }
-
-  void AddVertexIndex(XMINT4& v, int index) {
-    if (v.x == -1) {
-      v.x = index;
-      return;
-    }
-    if (v.y == -1) {
-      v.y = index;
-      return;
-    }
-    if (v.z == -1) {
-      v.z = index;
-      return;
-    }
-    if (v.w == -1) {
-      v.w = index;
-      return;
-    }
-  }
-  void AddVertexWeight(XMFLOAT4& v, float weight) {
-    if (v.x < 0) {
-      v.x = weight;
-      return;
-    }
-    if (v.y < 0) {
-      v.y = weight;
-      return;
-    }
-    if (v.z < 0) {
-      v.z = weight;
-      return;
-    }
-    if (v.w < 0) {
-      v.w = weight;
-      return;
-    }
-  }
-  DirectX::XMMATRIX ConvertMatrix(const aiMatrix4x4& mtx) {
-    DirectX::XMFLOAT4X4 m(mtx[0]);
-    return XMMatrixTranspose(XMLoadFloat4x4(&m));
-  }
-
-
-}
-
-namespace model {
-  ModelAsset LoadModelData(std::filesystem::path filePath, D3D12AppBase* appBase, ModelLoadFlag loadFlags) {
-    auto fileName = filePath.string();
-    ModelAsset model;
-    model.importer = new Assimp::Importer();
-    uint32_t flags = 0;
-    flags |= aiProcess_Triangulate;
-    if (loadFlags & ModelLoadFlag_CalcTangent) {
-      flags |= aiProcess_CalcTangentSpace;
-    }
-    if (loadFlags & ModelLoadFlag_Flip_UV) {
-      flags |= aiProcess_FlipUVs;
-    }
-    model.scene = model.importer->ReadFile(fileName, flags);
-
-    auto scene = model.scene;
-    UINT totalVertexCount = 0, totalIndexCount = 0;
-    bool hasBone = false, hasTangent = false;
-
-    std::stack<std::shared_ptr<Node>> nodes;
-    model.rootNode = std::make_shared<Node>();
-    nodes.push(model.rootNode);
-
-    std::stack<aiNode*> nodeStack;
-    nodeStack.push(scene->mRootNode);
-    while (!nodeStack.empty()) {
-      auto* node = nodeStack.top();
-      nodeStack.pop();
-
-      auto nodeTarget = nodes.top(); nodes.pop();
-
-      for (uint32_t i = 0; i < node->mNumChildren; ++i) {
-        nodeStack.push(node->mChildren[i]);
-      }
-      // p̎qm[h𐶐.
-      for (uint32_t i = 0; i < node->mNumChildren; ++i) {
-        auto child = std::make_shared<Node>();
-        nodeTarget->children.push_back(child);
-        nodes.push(child);
-      }
-
-      auto name = ConvertFromUTF8(node->mName.C_Str());
-      auto meshCount = node->mNumMeshes;
-      nodeTarget->name = name;
-
-      if (meshCount > 0) {
-        for (uint32_t i = 0; i < node->mNumMeshes; ++i) {
-          auto meshIndex = node->mMeshes[i];
-          const auto* mesh = scene->mMeshes[meshIndex];
-          totalVertexCount += mesh->mNumVertices;
-          totalIndexCount += mesh->mNumFaces * 3;
-          hasBone |= mesh->HasBones();
-          hasTangent |= mesh->HasTangentsAndBitangents();
-        }
-      }
-      nodeTarget->transform = ConvertMatrix(node->mTransformation);
-    }
-
-    auto vbDescPN = CD3DX12_RESOURCE_DESC::Buffer(sizeof(XMFLOAT3) * totalVertexCount);
-    model.Position = appBase->CreateResource(vbDescPN, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, D3D12_HEAP_TYPE_UPLOAD);
-    model.Normal = appBase->CreateResource(vbDescPN, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, D3D12_HEAP_TYPE_UPLOAD);
-
-    auto vbDescT = CD3DX12_RESOURCE_DESC::Buffer(sizeof(XMFLOAT2) * totalVertexCount);
-    model.UV0 = appBase->CreateResource(vbDescPN, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, D3D12_HEAP_TYPE_UPLOAD);
-
-    if (hasTangent) {
-      model.Tangent = appBase->CreateResource(vbDescPN, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, D3D12_HEAP_TYPE_UPLOAD);
-    }
-    if (hasBone) {
-      auto vbDescB = CD3DX12_RESOURCE_DESC::Buffer(sizeof(XMINT4) * totalVertexCount);
-      model.BoneIndices = appBase->CreateResource(vbDescB, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, D3D12_HEAP_TYPE_UPLOAD);
-
-      auto vbDescW = CD3DX12_RESOURCE_DESC::Buffer(sizeof(XMFLOAT4) * totalVertexCount);
-      model.BoneWeights = appBase->CreateResource(vbDescW, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, D3D12_HEAP_TYPE_UPLOAD);
-    }
-
-    auto ibDesc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(UINT) * totalIndexCount);
-    model.Indices = appBase->CreateResource(ibDesc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, D3D12_HEAP_TYPE_UPLOAD);
-
-    std::vector<XMFLOAT3> vbPos, vbNrm;
-    std::vector<XMFLOAT2> vbUV0;
-    std::vector<XMINT4>  vbBIndices;
-    std::vector<XMFLOAT4> vbBWeights;
-    std::vector<XMFLOAT3> vbTangents;
-    std::vector<UINT> ibIndices;
-    vbPos.reserve(totalVertexCount);
-    vbNrm.reserve(totalVertexCount);
-    vbUV0.reserve(totalVertexCount);
-    vbBIndices.resize(totalVertexCount, XMINT4(-1, -1, -1, -1));
-    vbBWeights.resize(totalVertexCount, XMFLOAT4(-1.0f, -1.0f, -1.0f, -1.0f));
-    vbTangents.reserve(totalVertexCount);
-    ibIndices.reserve(totalIndexCount);
-
-    totalVertexCount = 0;
-    totalIndexCount = 0;
-    nodeStack.push(scene->mRootNode);
-    while (!nodeStack.empty()) {
-      auto* node = nodeStack.top();
-      nodeStack.pop();
-
-      for (uint32_t i = 0; i < node->mNumChildren; ++i) {
-        nodeStack.push(node->mChildren[i]);
-      }
-
-      auto name = ConvertFromUTF8(node->mName.C_Str());
-      auto meshCount = node->mNumMeshes;
-
-      if (meshCount > 0) {
-        for (uint32_t i = 0; i < node->mNumMeshes; ++i) {
-          auto meshIndex = node->mMeshes[i];
-          const auto* mesh = scene->mMeshes[meshIndex];
-
-          DrawBatch batch{};
-          batch.vertexOffsetCount = totalVertexCount;
-          batch.indexOffsetCount = totalIndexCount;
-          batch.indexCount = mesh->mNumFaces * 3;
-          batch.materialIndex = mesh->mMaterialIndex;
-
-          const auto* vPosStart = reinterpret_cast<const XMFLOAT3*>(mesh->mVertices);
-          vbPos.insert(vbPos.end(), vPosStart, vPosStart + mesh->mNumVertices);
-
-          const auto* vNrmStart = reinterpret_cast<const XMFLOAT3*>(mesh->mNormals);
-          vbNrm.insert(vbNrm.end(), vNrmStart, vNrmStart + mesh->mNumVertices);
-
-          std::vector<XMFLOAT2> uvWork(mesh->mNumVertices);
-          for (int j = 0; j < int(mesh->mNumVertices); ++j) {
-            const auto& src = mesh->mTextureCoords[0][j];
-            uvWork[j].x = src.x;
-            uvWork[j].y = src.y;
-          }
-
-          vbUV0.insert(vbUV0.end(), uvWork.begin(), uvWork.end());
-
-          if (hasTangent) {
-            const auto* vTangentStart = reinterpret_cast<const XMFLOAT3*>(mesh->mTangents);
-            vbTangents.insert(vbTangents.end(), vTangentStart, vTangentStart + mesh->mNumVertices);
-          }
-
-          for (int f = 0; f < int(mesh->mNumFaces); ++f) {
-            for (int fi = 0; fi < int(mesh->mFaces[f].mNumIndices); ++fi) {
-              auto vertexIndex = mesh->mFaces[f].mIndices[fi];
-              ibIndices.push_back(vertexIndex);
-            }
-          }
-
-          if (hasBone) {
-            if (mesh->HasBones()) {
-              // Lȃ{[̂𒊏o.
-              std::vector<std::string> boneNameList;
-              std::vector<aiBone*> activeBones;
-              std::vector<int> boneIndexList;
-              for (uint32_t j = 0; j < mesh->mNumBones; ++j) {
-                const auto bone = mesh->mBones[j];
-                auto name = ConvertFromUTF8(bone->mName.C_Str());
-                if (bone->mNumWeights > 0) {
-                  boneIndexList.push_back(int(boneNameList.size()));
-                  boneNameList.push_back(name);
-                  activeBones.push_back(bone);
-                }
-              }
-
-              auto vertexBase = batch.vertexOffsetCount;
-              for (int boneIndex = 0; boneIndex < int(activeBones.size()); ++boneIndex) {
-                auto bone = activeBones[boneIndex];
-                for (int j = 0; j < int(bone->mNumWeights); ++j) {
-                  auto weightInfo = bone->mWeights[j];
-                  auto vertexIndex = vertexBase + weightInfo.mVertexId;
-                  auto weight = weightInfo.mWeight;
-
-                  AddVertexIndex(vbBIndices[vertexIndex], boneIndex);
-                  AddVertexWeight(vbBWeights[vertexIndex], weight);
-                }
-              }
-
-              batch.boneList = activeBones;
-
-              for (int boneIndex = 0; boneIndex < int(activeBones.size()); ++boneIndex) {
-                auto bone = activeBones[boneIndex];
-                auto name = ConvertFromUTF8(bone->mName.C_Str());
-
-                auto node = model.FindNode(name);
-                assert(node != nullptr);
-                node->offsetMatrix = ConvertMatrix(bone->mOffsetMatrix);
-                batch.boneList2.push_back(node);
-              }
-
-              auto desc = CD3DX12_RESOURCE_DESC::Buffer(sizeof(XMMATRIX) * activeBones.size());
-              batch.boneMatrixPalette = appBase->CreateConstantBuffers(desc);
-            }
-          }
-          totalVertexCount += mesh->mNumVertices;
-          totalIndexCount += mesh->mNumFaces * 3;
-
-          model.DrawBatches.emplace_back(batch);
-          if (hasBone && batch.boneMatrixPalette.empty()) {
-            DebugBreak();
-          }
-          hasBone |= mesh->HasBones();
-        }
-      }
-    }
-
-    for (int i = 0; i<int(model.scene->mNumMaterials); ++i) {
-      Material m{};
-      auto material = model.scene->mMaterials[i];
-
-      fs::path baseDir(fileName);
-      baseDir = baseDir.parent_path();
-      aiString path;
-      auto ret = material->GetTexture(aiTextureType_DIFFUSE, 0, &path);
-      if (ret == aiReturn_SUCCESS) {
-        auto texfileName = ConvertFromUTF8(path.C_Str());
-        auto textureFilePath = (baseDir / texfileName).string();
-
-        auto tex = appBase->LoadTexture(textureFilePath);
-        m.albedoSRV = tex.srv;
-      } else {
-        auto tex = appBase->LoadTexture("assets/texture/white.png");
-        m.albedoSRV = tex.srv;
-      }
-
-      ret = material->GetTexture(aiTextureType_SPECULAR, 0, &path);
-      if (ret == aiReturn_SUCCESS) {
-        auto texfileName = ConvertFromUTF8(path.C_Str());
-        auto textureFilePath = (baseDir / texfileName).string();
-
-        auto tex = appBase->LoadTexture(textureFilePath);
-        m.specularSRV = tex.srv;
-      } else {
-        auto tex = appBase->LoadTexture("assets/texture/black.png");
-        m.specularSRV = tex.srv;
-      }
-
-      float shininess = 0;
-      ret = material->Get(AI_MATKEY_SHININESS, shininess);
-      m.shininess = shininess;
-
-      aiColor3D diffuse{};
-      ret = material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuse);
-      m.diffuse = XMFLOAT3(diffuse.r, diffuse.g, diffuse.b);
-
-      aiColor3D ambient{};
-      ret = material->Get(AI_MATKEY_COLOR_AMBIENT, ambient);
-      m.ambient = XMFLOAT3(ambient.r, ambient.g, ambient.b);
-
-      model.materials.push_back(m);
-    }
-    model.totalVertexCount = totalVertexCount;
-    model.totalIndexCount = totalIndexCount;
-
-    if (hasBone) {
-      // {[񖢐ݒ̈|.
-      for (auto& v : vbBIndices) {
-        if (v.x < 0) { v.x = 0; }
-        if (v.y < 0) { v.y = 0; }
-        if (v.z < 0) { v.z = 0; }
-        if (v.w < 0) { v.w = 0; }
-      }
-      for (auto& v : vbBWeights) {
-        if (v.x < 0.0f) { v.x = 0.0f; }
-        if (v.y < 0.0f) { v.y = 0.0f; }
-        if (v.z < 0.0f) { v.z = 0.0f; }
-        if (v.w < 0.0f) { v.w = 0.0f; }
-
-        float total = v.x + v.y + v.z + v.w;
-        assert(std::abs(total) > 0.999f && std::abs(total) < 1.01f);
-      }
-    }
-
-    appBase->WriteToUploadHeapMemory(model.Position.Get(), uint32_t(sizeof(XMFLOAT3) * vbPos.size()), vbPos.data());
-    appBase->WriteToUploadHeapMemory(model.Normal.Get(), uint32_t(sizeof(XMFLOAT3) * vbNrm.size()), vbNrm.data());
-    appBase->WriteToUploadHeapMemory(model.UV0.Get(), uint32_t(sizeof(XMFLOAT2)* vbUV0.size()), vbUV0.data());
-    
-    if (hasTangent) {
-      appBase->WriteToUploadHeapMemory(model.Tangent.Get(), uint32_t(sizeof(XMFLOAT3) * vbTangents.size()), vbTangents.data());
-    }
-
-    if (hasBone) {
-      appBase->WriteToUploadHeapMemory(model.BoneIndices.Get(), uint32_t(sizeof(XMINT4) * vbBIndices.size()), vbBIndices.data());
-      appBase->WriteToUploadHeapMemory(model.BoneWeights.Get(), uint32_t(sizeof(XMFLOAT4) * vbBWeights.size()), vbBWeights.data());
-    }
-    appBase->WriteToUploadHeapMemory(model.Indices.Get(), uint32_t(sizeof(UINT) * ibIndices.size()), ibIndices.data());
-
-    model.vertexBufferViews[ModelAsset::VBV_Position] = {
-      model.Position->GetGPUVirtualAddress(), uint32_t(sizeof(XMFLOAT3) * vbPos.size()), uint32_t(sizeof(XMFLOAT3))
-    };
-    model.vertexBufferViews[ModelAsset::VBV_Normal] = {
-      model.Normal->GetGPUVirtualAddress(), uint32_t(sizeof(XMFLOAT3) * vbNrm.size()), uint32_t(sizeof(XMFLOAT3))
-    };
-    model.vertexBufferViews[ModelAsset::VBV_UV0] = {
-      model.UV0->GetGPUVirtualAddress(), uint32_t(sizeof(XMFLOAT2) * vbUV0.size()), uint32_t(sizeof(XMFLOAT2))
-    };
-    if (hasTangent) {
-      model.vertexBufferViews[ModelAsset::VBV_Tangent] = {
-        model.Tangent->GetGPUVirtualAddress(), uint32_t(sizeof(XMFLOAT3) * vbTangents.size()), uint32_t(sizeof(XMFLOAT3))
-      };
-    }
-    if (hasBone) {
-      model.vertexBufferViews[ModelAsset::VBV_BlendIndices] = {
-        model.BoneIndices->GetGPUVirtualAddress(), uint32_t(sizeof(XMINT4) * vbBIndices.size()), sizeof(XMINT4)
-      };
-      model.vertexBufferViews[ModelAsset::VBV_BlendWeights] = {
-        model.BoneWeights->GetGPUVirtualAddress(), uint32_t(sizeof(XMFLOAT4) * vbBWeights.size()), sizeof(XMFLOAT4)
-      };
-    }
-    model.indexBufferView = { model.Indices->GetGPUVirtualAddress(), uint32_t(sizeof(UINT) * ibIndices.size()), DXGI_FORMAT_R32_UINT };
-
-    auto mtx = ConvertMatrix(scene->mRootNode->mTransformation);
-    model.invGlobalTransform = XMMatrixInverse(nullptr, mtx);
-    return model;
-  }
-
-
-  void Node::UpdateMatrices(DirectX::XMMATRIX mtxParent) {
-    worldTransform = transform * mtxParent;
-
-    for (auto& c : children) {
-      c->UpdateMatrices(worldTransform);
-    }
-  }
-
-  void ModelAsset::Release() {
-    delete importer;
-    importer = nullptr;
-    scene = nullptr;
-
-    Position = nullptr;
-    Normal = nullptr; 
-    UV0 = nullptr;
-    BoneIndices = nullptr; 
-    BoneWeights = nullptr;
-    Tangent = nullptr;
-    Indices = nullptr;
-
-    DrawBatches.clear();
-    extraBuffers.clear();
-    extraHandles.clear();
-    rootNode.reset();
-  }
-
-  std::shared_ptr<Node> ModelAsset::FindNode(const std::string& name) {
-    std::stack<std::shared_ptr<Node>> nodes;
-    nodes.push(rootNode);
-    while (!nodes.empty()) {
-      auto node = nodes.top();
-      nodes.pop();
-
-      if (node->name == name) {
-        return node;
-      }
-
-      for (auto& child : node->children) {
-        nodes.push(child);
-      }
-    }
-    return nullptr;
-  }
-
+#include "Model.h"
+#include "MeshOptimizer.h"
+#include "MeshSimplifier.h"
+#include "TangentSpace.h"
+#include "TextureDecoder.h"
+
+#include <DirectXTex.h>
+#include <DirectXPackedVector.h>
+#include <fstream>
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <iterator>
+#include <stack>
+#include <type_traits>
+#include <chrono>
+#include <unordered_set>
+
+#include <assimp/Importer.hpp>
+#include <assimp/scene.h>
+#include <assimp/postprocess.h>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+namespace fs = std::filesystem;
+
+namespace {
+  std::string ConvertFromUTF8(const char* utf8Str)
+  {
+    DWORD dwRet = MultiByteToWideChar(CP_UTF8, 0, utf8Str, -1, NULL, 0);
+    std::vector<wchar_t> wstrbuf;
+    wstrbuf.resize(dwRet);
+
+    MultiByteToWideChar(CP_UTF8, 0, utf8Str, -1, wstrbuf.data(), int(wstrbuf.size()));
+
+    dwRet = WideCharToMultiByte(932, 0, wstrbuf.data(), -1, NULL, 0, NULL, NULL);
+    std::vector<char> strbuf;
+    strbuf.resize(dwRet);
+
+    WideCharToMultiByte(932, 0, wstrbuf.data(), -1, strbuf.data(), int(strbuf.size()), NULL, NULL);
+    return std::string(strbuf.data());
+  }
+
+  void AddVertexIndex(XMINT4& v, int index) {
+    if (v.x == -1) {
+      v.x = index;
+      return;
+    }
+    if (v.y == -1) {
+      v.y = index;
+      return;
+    }
+    if (v.z == -1) {
+      v.z = index;
+      return;
+    }
+    if (v.w == -1) {
+      v.w = index;
+      return;
+    }
+  }
+  void AddVertexWeight(XMFLOAT4& v, float weight) {
+    if (v.x < 0) {
+      v.x = weight;
+      return;
+    }
+    if (v.y < 0) {
+      v.y = weight;
+      return;
+    }
+    if (v.z < 0) {
+      v.z = weight;
+      return;
+    }
+    if (v.w < 0) {
+      v.w = weight;
+      return;
+    }
+  }
+  DirectX::XMMATRIX ConvertMatrix(const aiMatrix4x4& mtx) {
+    DirectX::XMFLOAT4X4 m(mtx[0]);
+    return XMMatrixTranspose(XMLoadFloat4x4(&m));
+  }
+
+  // 三角形の面の数. 点と線の面は描画しないので数えない.
+  UINT CountTriangles(const aiMesh* mesh) {
+    UINT count = 0;
+    for (UINT f = 0; f < mesh->mNumFaces; ++f) {
+      count += (mesh->mFaces[f].mNumIndices == 3) ? 1 : 0;
+    }
+    return count;
+  }
+
+  // Assimp でモデルを読み込み、CPU 側のデータへ変換する.
+  // Assimp のシーンは変換後に不要になるため, この関数を抜けた時点で解放される.
+  void ImportModelSource(const std::string& fileName, model::ModelLoadFlag loadFlags, model::ModelSourceData& source) {
+    using namespace model;
+    Assimp::Importer importer;
+    uint32_t flags = 0;
+    flags |= aiProcess_Triangulate;
+    // Triangulate は点と線を残すので, 種類ごとに分けて取り除く.
+    flags |= aiProcess_SortByPType;
+    importer.SetPropertyInteger(AI_CONFIG_PP_SBP_REMOVE, aiPrimitiveType_POINT | aiPrimitiveType_LINE);
+    if (loadFlags & ModelLoadFlag_Flip_UV) {
+      flags |= aiProcess_FlipUVs;
+    }
+    auto scene = importer.ReadFile(fileName, flags);
+    if (scene == nullptr) {
+      throw std::runtime_error("Model file load failed.");
+    }
+
+    UINT totalVertexCount = 0, totalIndexCount = 0;
+    bool hasBone = false;
+
+    // ノード階層を親が先に来る順序で平坦化し、描画するメッシュを列挙.
+    std::vector<UINT> meshList;
+    std::unordered_map<std::string, int> nodeIndexMap;
+    std::stack<std::pair<aiNode*, int>> nodeStack;
+    nodeStack.push({ scene->mRootNode, -1 });
+    while (!nodeStack.empty()) {
+      auto [node, parent] = nodeStack.top();
+      nodeStack.pop();
+
+      int nodeIndex = int(source.nodes.size());
+      for (uint32_t i = 0; i < node->mNumChildren; ++i) {
+        nodeStack.push({ node->mChildren[i], nodeIndex });
+      }
+
+      ModelSourceData::NodeInfo info{};
+      info.name = ConvertFromUTF8(node->mName.C_Str());
+      info.parent = parent;
+      XMStoreFloat4x4(&info.transform, ConvertMatrix(node->mTransformation));
+      XMStoreFloat4x4(&info.offsetMatrix, XMMatrixIdentity());
+      nodeIndexMap.emplace(info.name, nodeIndex);
+      source.nodes.emplace_back(std::move(info));
+
+      for (uint32_t i = 0; i < node->mNumMeshes; ++i) {
+        auto meshIndex = node->mMeshes[i];
+        const auto* mesh = scene->mMeshes[meshIndex];
+        if (CountTriangles(mesh) == 0) {
+          continue;
+        }
+        hasBone |= mesh->HasBones();
+        meshList.push_back(meshIndex);
+      }
+    }
+
+    // 各メッシュの書き込み先オフセットを先に確定させる.
+    totalVertexCount = 0;
+    totalIndexCount = 0;
+    for (auto meshIndex : meshList) {
+      const auto* mesh = scene->mMeshes[meshIndex];
+
+      ModelSourceData::Batch batch{};
+      batch.vertexOffsetCount = totalVertexCount;
+      batch.vertexCount = mesh->mNumVertices;
+      batch.indexOffsetCount = totalIndexCount;
+      batch.indexCount = CountTriangles(mesh) * 3;
+      batch.materialIndex = mesh->mMaterialIndex;
+      batch.meshIndex = meshIndex;
+
+      totalVertexCount += mesh->mNumVertices;
+      totalIndexCount += batch.indexCount;
+      source.batches.emplace_back(std::move(batch));
+    }
+
+    auto& vbPos = source.position;
+    auto& vbNrm = source.normal;
+    auto& vbUV0 = source.uv0;
+    auto& vbBIndices = source.boneIndices;
+    auto& vbBWeights = source.boneWeights;
+    auto& ibIndices = source.indices;
+    vbPos.resize(totalVertexCount);
+    vbNrm.resize(totalVertexCount);
+    vbUV0.resize(totalVertexCount);
+    if (hasBone) {
+      vbBIndices.resize(totalVertexCount, XMINT4(-1, -1, -1, -1));
+      vbBWeights.resize(totalVertexCount, XMFLOAT4(-1.0f, -1.0f, -1.0f, -1.0f));
+    }
+    ibIndices.resize(totalIndexCount);
+
+    // メッシュ単位で並列に詰める. 各メッシュの書き込み範囲は重ならない.
+    std::for_each(std::execution::par, source.batches.begin(), source.batches.end(), [&](const ModelSourceData::Batch& batch) {
+      const auto* mesh = scene->mMeshes[batch.meshIndex];
+      const auto vertexBase = batch.vertexOffsetCount;
+      const auto vertexCount = mesh->mNumVertices;
+
+      const auto* vPosStart = reinterpret_cast<const XMFLOAT3*>(mesh->mVertices);
+      std::copy(vPosStart, vPosStart + vertexCount, vbPos.begin() + vertexBase);
+
+      if (mesh->HasNormals()) {
+        const auto* vNrmStart = reinterpret_cast<const XMFLOAT3*>(mesh->mNormals);
+        std::copy(vNrmStart, vNrmStart + vertexCount, vbNrm.begin() + vertexBase);
+      }
+
+      if (mesh->HasTextureCoords(0)) {
+        const auto* uvSrc = mesh->mTextureCoords[0];
+        for (UINT j = 0; j < vertexCount; ++j) {
+          vbUV0[vertexBase + j] = XMFLOAT2(uvSrc[j].x, uvSrc[j].y);
+        }
+      }
+
+      auto* dstIndices = ibIndices.data() + batch.indexOffsetCount;
+      for (UINT f = 0; f < mesh->mNumFaces; ++f) {
+        const auto& face = mesh->mFaces[f];
+        if (face.mNumIndices != 3) {
+          continue;
+        }
+        *dstIndices++ = face.mIndices[0];
+        *dstIndices++ = face.mIndices[1];
+        *dstIndices++ = face.mIndices[2];
+      }
+
+      if (hasBone && mesh->HasBones()) {
+        int boneIndex = 0;
+        for (uint32_t j = 0; j < mesh->mNumBones; ++j) {
+          const auto bone = mesh->mBones[j];
+          if (bone->mNumWeights == 0) {
+            continue;
+          }
+          for (int k = 0; k < int(bone->mNumWeights); ++k) {
+            auto weightInfo = bone->mWeights[k];
+            auto vertexIndex = vertexBase + weightInfo.mVertexId;
+            AddVertexIndex(vbBIndices[vertexIndex], boneIndex);
+            AddVertexWeight(vbBWeights[vertexIndex], weightInfo.mWeight);
+          }
+          ++boneIndex;
+        }
+      }
+    });
+
+    // ボーンとノードの対応付けはノード情報を書き換えるため逐次処理.
+    for (auto& batch : source.batches) {
+      const auto* mesh = scene->mMeshes[batch.meshIndex];
+      if (!hasBone || !mesh->HasBones()) {
+        continue;
+      }
+      for (uint32_t j = 0; j < mesh->mNumBones; ++j) {
+        const auto bone = mesh->mBones[j];
+        if (bone->mNumWeights == 0) {
+          continue;
+        }
+        auto name = ConvertFromUTF8(bone->mName.C_Str());
+        auto itr = nodeIndexMap.find(name);
+        assert(itr != nodeIndexMap.end());
+        XMStoreFloat4x4(&source.nodes[itr->second].offsetMatrix, ConvertMatrix(bone->mOffsetMatrix));
+        batch.boneNodes.push_back(itr->second);
+      }
+    }
+
+    if (hasBone) {
+      // ボーン情報未設定領域を掃除.
+      for (auto& v : vbBIndices) {
+        if (v.x < 0) { v.x = 0; }
+        if (v.y < 0) { v.y = 0; }
+        if (v.z < 0) { v.z = 0; }
+        if (v.w < 0) { v.w = 0; }
+      }
+      for (auto& v : vbBWeights) {
+        if (v.x < 0.0f) { v.x = 0.0f; }
+        if (v.y < 0.0f) { v.y = 0.0f; }
+        if (v.z < 0.0f) { v.z = 0.0f; }
+        if (v.w < 0.0f) { v.w = 0.0f; }
+
+        float total = v.x + v.y + v.z + v.w;
+        assert(std::abs(total) > 0.999f && std::abs(total) < 1.01f);
+      }
+    }
+
+    fs::path baseDir(fileName);
+    baseDir = baseDir.parent_path();
+    for (int i = 0; i<int(scene->mNumMaterials); ++i) {
+      ModelSourceData::MaterialInfo m{};
+      auto material = scene->mMaterials[i];
+
+      aiString path;
+      auto ret = material->GetTexture(aiTextureType_DIFFUSE, 0, &path);
+      if (ret == aiReturn_SUCCESS) {
+        auto texfileName = ConvertFromUTF8(path.C_Str());
+        m.albedoTexture = (baseDir / texfileName).string();
+      }
+
+      ret = material->GetTexture(aiTextureType_SPECULAR, 0, &path);
+      if (ret == aiReturn_SUCCESS) {
+        auto texfileName = ConvertFromUTF8(path.C_Str());
+        m.specularTexture = (baseDir / texfileName).string();
+      }
+
+      float shininess = 0;
+      ret = material->Get(AI_MATKEY_SHININESS, shininess);
+      m.shininess = shininess;
+
+      aiColor3D diffuse{};
+      ret = material->Get(AI_MATKEY_COLOR_DIFFUSE, diffuse);
+      m.diffuse = XMFLOAT3(diffuse.r, diffuse.g, diffuse.b);
+
+      aiColor3D ambient{};
+      ret = material->Get(AI_MATKEY_COLOR_AMBIENT, ambient);
+      m.ambient = XMFLOAT3(ambient.r, ambient.g, ambient.b);
+
+      source.materials.emplace_back(std::move(m));
+    }
+
+    // アニメーションをクリップごとのキー配列へ変換. 時間の単位は秒にそろえる.
+    for (uint32_t i = 0; i < scene->mNumAnimations; ++i) {
+      const auto* anim = scene->mAnimations[i];
+      double ticksPerSecond = anim->mTicksPerSecond > 0.0 ? anim->mTicksPerSecond : 25.0;
+      auto toSeconds = [&](double ticks) { return float(ticks / ticksPerSecond); };
+
+      animation::AnimationClip clip;
+      clip.name = ConvertFromUTF8(anim->mName.C_Str());
+      clip.duration = toSeconds(anim->mDuration);
+      for (uint32_t j = 0; j < anim->mNumChannels; ++j) {
+        const auto* channel = anim->mChannels[j];
+        auto itr = nodeIndexMap.find(ConvertFromUTF8(channel->mNodeName.C_Str()));
+        if (itr == nodeIndexMap.end()) {
+          continue;
+        }
+        animation::Track track{};
+        track.node = itr->second;
+        track.positionOffset = uint32_t(clip.positionTimes.size());
+        track.positionCount = channel->mNumPositionKeys;
+        for (uint32_t k = 0; k < channel->mNumPositionKeys; ++k) {
+          const auto& key = channel->mPositionKeys[k];
+          clip.positionTimes.push_back(toSeconds(key.mTime));
+          clip.positionValues.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z);
+        }
+        track.rotationOffset = uint32_t(clip.rotationTimes.size());
+        track.rotationCount = channel->mNumRotationKeys;
+        for (uint32_t k = 0; k < channel->mNumRotationKeys; ++k) {
+          const auto& key = channel->mRotationKeys[k];
+          clip.rotationTimes.push_back(toSeconds(key.mTime));
+          clip.rotationValues.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z, key.mValue.w);
+        }
+        track.scaleOffset = uint32_t(clip.scaleTimes.size());
+        track.scaleCount = channel->mNumScalingKeys;
+        for (uint32_t k = 0; k < channel->mNumScalingKeys; ++k) {
+          const auto& key = channel->mScalingKeys[k];
+          clip.scaleTimes.push_back(toSeconds(key.mTime));
+          clip.scaleValues.emplace_back(key.mValue.x, key.mValue.y, key.mValue.z);
+        }
+        clip.tracks.push_back(track);
+      }
+      source.animations.emplace_back(std::move(clip));
+    }
+
+    auto mtx = ConvertMatrix(scene->mRootNode->mTransformation);
+    XMStoreFloat4x4(&source.invGlobalTransform, XMMatrixInverse(nullptr, mtx));
+  }
+
+  // バッチごとにインデックスの並び替えと頂点の並べ替えを行う.
+  // 全ストリームが一致する頂点をバッチ内で 1 つにまとめ, インデックスを書き換える.
+  // バッチ番号も比較対象に加えて全頂点を一度に処理する. 新番号は出現順なのでバッチの範囲は連続したまま.
+  void WeldModelSource(const std::string& fileName, model::ModelSourceData& source) {
+    using namespace mesh_optimizer;
+    auto vertexCount = uint32_t(source.position.size());
+    std::vector<uint32_t> batchIds(vertexCount);
+    for (uint32_t b = 0; b < uint32_t(source.batches.size()); ++b) {
+      const auto& batch = source.batches[b];
+      std::fill_n(batchIds.begin() + batch.vertexOffsetCount, batch.vertexCount, b);
+    }
+
+    std::vector<VertexStream> streams;
+    auto addStream = [&](const auto& v) {
+      if (!v.empty()) {
+        streams.push_back({ v.data(), sizeof(v[0]) });
+      }
+    };
+    addStream(batchIds);
+    addStream(source.position);
+    addStream(source.normal);
+    addStream(source.uv0);
+    addStream(source.tangent);
+    addStream(source.boneIndices);
+    addStream(source.boneWeights);
+
+    uint32_t uniqueCount = 0;
+    auto remap = GenerateWeldRemap(streams.data(), streams.size(), vertexCount, uniqueCount);
+    if (uniqueCount == vertexCount) {
+      return;
+    }
+
+    std::vector<size_t> batchIndices(source.batches.size());
+    std::iota(batchIndices.begin(), batchIndices.end(), size_t(0));
+    std::for_each(std::execution::par, batchIndices.begin(), batchIndices.end(), [&](size_t i) {
+      auto& batch = source.batches[i];
+      auto oldOffset = batch.vertexOffsetCount;
+      // 先頭の頂点は必ずバッチ内の代表なので, その新番号が新しい開始位置になる.
+      auto newOffset = batch.vertexCount ? remap[oldOffset] : 0;
+      auto* indices = source.indices.data() + batch.indexOffsetCount;
+      for (UINT j = 0; j < batch.indexCount; ++j) {
+        indices[j] = remap[oldOffset + indices[j]] - newOffset;
+      }
+      UINT newCount = 0;
+      for (UINT j = 0; j < batch.vertexCount; ++j) {
+        newCount = std::max(newCount, remap[oldOffset + j] - newOffset + 1);
+      }
+      batch.vertexOffsetCount = newOffset;
+      batch.vertexCount = newCount;
+    });
+
+    auto compact = [&](auto& v) {
+      if (!v.empty()) {
+        v = CompactVertexStream(v, remap, uniqueCount);
+      }
+    };
+    compact(source.position);
+    compact(source.normal);
+    compact(source.uv0);
+    compact(source.tangent);
+    compact(source.boneIndices);
+    compact(source.boneWeights);
+
+    char buf[512];
+    sprintf_s(buf, "%s: Weld vertices %u -> %u\n", fileName.c_str(), vertexCount, uniqueCount);
+    OutputDebugStringA(buf);
+  }
+
+  // テクスチャ指定の無いマテリアルはデフォルトテクスチャを使う.
+  std::string GetAlbedoTextureName(const model::ModelSourceData::MaterialInfo& info) {
+    return info.albedoTexture.empty() ? "assets/texture/white.png" : info.albedoTexture;
+  }
+  std::string GetSpecularTextureName(const model::ModelSourceData::MaterialInfo& info) {
+    return info.specularTexture.empty() ? "assets/texture/black.png" : info.specularTexture;
+  }
+
+  // 読み込み済み (loadedKeys に含まれる) テクスチャは予約しない.
+  std::vector<std::shared_future<TextureDecoder::ImagePtr>> RequestMaterialTextures(
+    const model::ModelSourceData& source, TextureDecoder& decoder, const std::unordered_set<std::string>& loadedKeys) {
+    std::vector<std::shared_future<TextureDecoder::ImagePtr>> requests;
+    for (const auto& info : source.materials) {
+      for (const auto& name : { GetAlbedoTextureName(info), GetSpecularTextureName(info) }) {
+        if (loadedKeys.find(TextureDecoder::GetRequestKey(name, false)) == loadedKeys.end()) {
+          requests.push_back(decoder.Request(name));
+        }
+      }
+    }
+    return requests;
+  }
+
+  // バッチローカルのインデックスを全体の頂点番号へ直して 1 つの BVH にまとめる.
+  std::shared_ptr<const bvh::TriangleBvh> BuildModelBvh(const model::ModelSourceData& source) {
+    std::vector<uint32_t> triangles;
+    triangles.reserve(source.indices.size());
+    for (const auto& batch : source.batches) {
+      auto begin = source.indices.begin() + batch.indexOffsetCount;
+      std::transform(begin, begin + batch.indexCount, std::back_inserter(triangles),
+        [&](UINT v) { return v + batch.vertexOffsetCount; });
+    }
+    auto tree = std::make_shared<bvh::TriangleBvh>();
+    tree->Build(source.position.data(), triangles.data(), triangles.size());
+    return tree;
+  }
+
+  // バッチごとに並列で接線を生成する. 各バッチの頂点範囲は重ならない.
+  void GenerateModelTangents(model::ModelSourceData& source) {
+    source.tangent.resize(source.position.size());
+    std::for_each(std::execution::par, source.batches.begin(), source.batches.end(), [&](const model::ModelSourceData::Batch& batch) {
+      auto offset = batch.vertexOffsetCount;
+      tangent_space::GenerateTangents(
+        source.indices.data() + batch.indexOffsetCount, batch.indexCount,
+        source.position.data() + offset, source.normal.data() + offset, source.uv0.data() + offset,
+        batch.vertexCount, source.tangent.data() + offset);
+    });
+  }
+
+  void OptimizeModelSource(const std::string& fileName, model::ModelSourceData& source) {
+    using namespace mesh_optimizer;
+    std::vector<VertexCacheStats> before(source.batches.size()), after(source.batches.size());
+    std::vector<size_t> batchIndices(source.batches.size());
+    std::iota(batchIndices.begin(), batchIndices.end(), size_t(0));
+
+    std::for_each(std::execution::par, batchIndices.begin(), batchIndices.end(), [&](size_t i) {
+      const auto& batch = source.batches[i];
+      auto* indices = source.indices.data() + batch.indexOffsetCount;
+      const auto* positions = source.position.data() + batch.vertexOffsetCount;
+
+      before[i] = AnalyzeVertexCache(indices, batch.indexCount, batch.vertexCount);
+      OptimizeVertexCache(indices, batch.indexCount, batch.vertexCount);
+      OptimizeOverdraw(indices, batch.indexCount, positions, batch.vertexCount);
+      after[i] = AnalyzeVertexCache(indices, batch.indexCount, batch.vertexCount);
+
+      auto remap = OptimizeVertexFetchRemap(indices, batch.indexCount, batch.vertexCount);
+      auto offset = batch.vertexOffsetCount;
+      RemapVertexStream(source.position.data() + offset, remap);
+      if (!source.normal.empty()) {
+        RemapVertexStream(source.normal.data() + offset, remap);
+      }
+      if (!source.uv0.empty()) {
+        RemapVertexStream(source.uv0.data() + offset, remap);
+      }
+      if (!source.tangent.empty()) {
+        RemapVertexStream(source.tangent.data() + offset, remap);
+      }
+      if (!source.boneIndices.empty()) {
+        RemapVertexStream(source.boneIndices.data() + offset, remap);
+        RemapVertexStream(source.boneWeights.data() + offset, remap);
+      }
+    });
+
+    VertexCacheStats totalBefore, totalAfter;
+    for (size_t i = 0; i < source.batches.size(); ++i) {
+      totalBefore += before[i];
+      totalAfter += after[i];
+    }
+    char buf[512];
+    sprintf_s(buf, "%s: ACMR %.3f -> %.3f, ATVR %.3f -> %.3f\n",
+      fileName.c_str(),
+      totalBefore.GetACMR(), totalAfter.GetACMR(),
+      totalBefore.GetATVR(), totalAfter.GetATVR());
+    OutputDebugStringA(buf);
+  }
+
+  // バッチごとにメッシュレットを生成して 1 つにまとめる.
+  void BuildModelMeshlets(model::ModelSourceData& source) {
+    std::vector<meshlet::MeshletData> work(source.batches.size());
+    std::vector<size_t> batchIndices(source.batches.size());
+    std::iota(batchIndices.begin(), batchIndices.end(), size_t(0));
+
+    std::for_each(std::execution::par, batchIndices.begin(), batchIndices.end(), [&](size_t i) {
+      const auto& batch = source.batches[i];
+      meshlet::BuildMeshlets(
+        source.indices.data() + batch.indexOffsetCount, batch.indexCount,
+        source.position.data() + batch.vertexOffsetCount, batch.vertexCount,
+        work[i]);
+    });
+
+    source.meshlets = meshlet::MeshletData();
+    for (size_t i = 0; i < source.batches.size(); ++i) {
+      auto& batch = source.batches[i];
+      batch.meshletOffset = UINT(source.meshlets.meshlets.size());
+      batch.meshletCount = UINT(work[i].meshlets.size());
+      source.meshlets.Append(work[i]);
+    }
+  }
+
+  // 各レベルで三角形数を半分にしつつ, 許容誤差 (バッチ半径比) を超えない範囲で LOD を生成する.
+  const float LodTargetErrors[] = { 0.005f, 0.01f, 0.02f, 0.04f };
+
+  void GenerateModelLods(const std::string& fileName, model::ModelSourceData& source) {
+    std::vector<std::vector<std::vector<uint32_t>>> lodIndices(source.batches.size());
+    std::vector<std::vector<float>> lodErrors(source.batches.size());
+    std::vector<size_t> batchIndices(source.batches.size());
+    std::iota(batchIndices.begin(), batchIndices.end(), size_t(0));
+
+    std::for_each(std::execution::par, batchIndices.begin(), batchIndices.end(), [&](size_t i) {
+      const auto& batch = source.batches[i];
+      mesh_optimizer::SimplifyVertexInput input;
+      input.positions = source.position.data() + batch.vertexOffsetCount;
+      if (!source.boneIndices.empty()) {
+        input.boneIndices = source.boneIndices.data() + batch.vertexOffsetCount;
+        input.boneWeights = source.boneWeights.data() + batch.vertexOffsetCount;
+      }
+      input.vertexCount = batch.vertexCount;
+
+      // 直前のレベルをさらに簡略化していく. 誤差は各段の累積で見積もる.
+      std::vector<uint32_t> current(
+        source.indices.begin() + batch.indexOffsetCount,
+        source.indices.begin() + batch.indexOffsetCount + batch.indexCount);
+      float totalError = 0.0f;
+      for (auto targetError : LodTargetErrors) {
+        auto target = (current.size() / 3 / 2) * 3;
+        float error = 0.0f;
+        auto simplified = mesh_optimizer::SimplifyMesh(
+          current.data(), current.size(), input, target, targetError - totalError, &error);
+        // ほとんど減らなければ打ち切る.
+        if (simplified.size() * 10 > current.size() * 9) {
+          break;
+        }
+        mesh_optimizer::OptimizeVertexCache(simplified.data(), simplified.size(), batch.vertexCount);
+        totalError += error;
+        lodErrors[i].push_back(totalError);
+        lodIndices[i].push_back(simplified);
+        current = std::move(simplified);
+      }
+    });
+
+    size_t baseTriangles = 0, lodTriangles = 0;
+    for (size_t i = 0; i < source.batches.size(); ++i) {
+      auto& batch = source.batches[i];
+      batch.lods.clear();
+      batch.lods.push_back({ batch.indexOffsetCount, batch.indexCount, 0.0f });
+      for (size_t level = 0; level < lodIndices[i].size(); ++level) {
+        const auto& indices = lodIndices[i][level];
+        batch.lods.push_back({ UINT(source.indices.size()), UINT(indices.size()), lodErrors[i][level] });
+        source.indices.insert(source.indices.end(), indices.begin(), indices.end());
+      }
+      baseTriangles += batch.indexCount / 3;
+      lodTriangles += batch.lods.back().indexCount / 3;
+    }
+
+    char buf[512];
+    sprintf_s(buf, "%s: LOD triangles %zu -> %zu\n", fileName.c_str(), baseTriangles, lodTriangles);
+    OutputDebugStringA(buf);
+  }
+
+  // ---- 頂点の量子化 ----
+  XMUSHORTN4 QuantizeUNorm16(const XMFLOAT3& v) {
+    auto q = [](float f) { return uint16_t(std::clamp(f, 0.0f, 1.0f) * 65535.0f + 0.5f); };
+    XMUSHORTN4 result;
+    result.x = q(v.x);
+    result.y = q(v.y);
+    result.z = q(v.z);
+    result.w = 0;
+    return result;
+  }
+
+  // 単位ベクトルを八面体マッピングで 2 成分の SNORM16 に変換.
+  XMSHORTN2 EncodeOctahedral(const XMFLOAT3& n) {
+    float len = std::abs(n.x) + std::abs(n.y) + std::abs(n.z);
+    float x = 0.0f, y = 0.0f;
+    if (len > 0.0f) {
+      x = n.x / len;
+      y = n.y / len;
+      if (n.z < 0.0f) {
+        float ox = (1.0f - std::abs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float oy = (1.0f - std::abs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = ox;
+        y = oy;
+      }
+    }
+    auto q = [](float f) { return int16_t(std::round(std::clamp(f, -1.0f, 1.0f) * 32767.0f)); };
+    XMSHORTN2 result;
+    result.x = q(x);
+    result.y = q(y);
+    return result;
+  }
+
+  // 合計が 255 になるように丸めて UNORM8 へ変換.
+  XMUBYTEN4 QuantizeWeights(const XMFLOAT4& w) {
+    float src[4] = { w.x, w.y, w.z, w.w };
+    int q[4];
+    int total = 0, largest = 0;
+    for (int i = 0; i < 4; ++i) {
+      q[i] = int(std::clamp(src[i], 0.0f, 1.0f) * 255.0f + 0.5f);
+      total += q[i];
+      if (q[i] > q[largest]) {
+        largest = i;
+      }
+    }
+    if (total > 0) {
+      q[largest] = std::clamp(q[largest] + 255 - total, 0, 255);
+    }
+    XMUBYTEN4 result;
+    result.x = uint8_t(q[0]);
+    result.y = uint8_t(q[1]);
+    result.z = uint8_t(q[2]);
+    result.w = uint8_t(q[3]);
+    return result;
+  }
+
+  // ---- バイナリキャッシュ ----
+  // ファイル構成: ヘッダ, 頂点ストリーム群, インデックス, メッシュレット, バッチ, ノード, マテリアルの順.
+  const char     ModelCacheMagic[4] = { 'M', 'D', 'L', 'C' };
+  const uint32_t ModelCacheVersion = 7;
+  // キャッシュする ModelSourceData の内容を変えるフラグだけを比較する.
+  // 接線は読み込み後に生成でき, BVH はキャッシュせず, それ以外は CreateModelAsset で適用されるので含めない.
+  const uint32_t ModelCacheKeyFlags = model::ModelLoadFlag_Flip_UV | model::ModelLoadFlag_WeldVertices |
+    model::ModelLoadFlag_OptimizeMesh | model::ModelLoadFlag_BuildMeshlets | model::ModelLoadFlag_GenerateLod;
+
+  struct ModelCacheHeader {
+    char     magic[4];
+    uint32_t version;
+    uint32_t loadFlags;
+    uint32_t reserved;
+    uint64_t sourceFileSize;
+    int64_t  sourceWriteTime;
+  };
+
+  fs::path GetCachePath(const fs::path& filePath) {
+    auto cachePath = filePath;
+    cachePath += ".mdlcache";
+    return cachePath;
+  }
+
+  bool MakeCacheHeader(const fs::path& filePath, model::ModelLoadFlag loadFlags, ModelCacheHeader& header) {
+    std::error_code ec;
+    auto fileSize = fs::file_size(filePath, ec);
+    if (ec) {
+      return false;
+    }
+    auto writeTime = fs::last_write_time(filePath, ec);
+    if (ec) {
+      return false;
+    }
+    header = ModelCacheHeader{};
+    memcpy(header.magic, ModelCacheMagic, sizeof(header.magic));
+    header.version = ModelCacheVersion;
+    header.loadFlags = uint32_t(loadFlags) & ModelCacheKeyFlags;
+    header.sourceFileSize = uint64_t(fileSize);
+    header.sourceWriteTime = int64_t(writeTime.time_since_epoch().count());
+    return true;
+  }
+
+  class CacheWriter {
+  public:
+    CacheWriter(std::ofstream& os) : m_os(os) { }
+
+    template<class T>
+    void Write(const T& v) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      m_os.write(reinterpret_cast<const char*>(&v), sizeof(T));
+    }
+    template<class T>
+    void WriteArray(const std::vector<T>& v) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      Write(uint64_t(v.size()));
+      m_os.write(reinterpret_cast<const char*>(v.data()), sizeof(T) * v.size());
+    }
+    void WriteString(const std::string& s) {
+      Write(uint32_t(s.size()));
+      m_os.write(s.data(), s.size());
+    }
+  private:
+    std::ofstream& m_os;
+  };
+
+  class CacheReader {
+  public:
+    CacheReader(const void* data, size_t size)
+      : m_cur(static_cast<const uint8_t*>(data)), m_end(static_cast<const uint8_t*>(data) + size) { }
+
+    template<class T>
+    bool Read(T& v) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      if (size_t(m_end - m_cur) < sizeof(T)) {
+        return false;
+      }
+      memcpy(&v, m_cur, sizeof(T));
+      m_cur += sizeof(T);
+      return true;
+    }
+    template<class T>
+    bool ReadArray(std::vector<T>& v) {
+      static_assert(std::is_trivially_copyable_v<T>);
+      uint64_t count = 0;
+      if (!Read(count) || count > uint64_t(m_end - m_cur) / sizeof(T)) {
+        return false;
+      }
+      // 文字列の後ろの配列は境界が揃っていないので, キャストせずにコピーする.
+      v.resize(size_t(count));
+      if (count > 0) {
+        memcpy(v.data(), m_cur, sizeof(T) * size_t(count));
+      }
+      m_cur += sizeof(T) * count;
+      return true;
+    }
+    bool ReadString(std::string& s) {
+      uint32_t length = 0;
+      if (!Read(length) || length > size_t(m_end - m_cur)) {
+        return false;
+      }
+      s.assign(reinterpret_cast<const char*>(m_cur), length);
+      m_cur += length;
+      return true;
+    }
+  private:
+    const uint8_t* m_cur;
+    const uint8_t* m_end;
+  };
+
+  // 読み取り専用のメモリマップドファイル.
+  class MappedFile {
+  public:
+    MappedFile(const fs::path& filePath) {
+      m_file = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+      if (m_file == INVALID_HANDLE_VALUE) {
+        return;
+      }
+      LARGE_INTEGER fileSize{};
+      if (!GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart == 0) {
+        return;
+      }
+      m_mapping = CreateFileMappingW(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (m_mapping == nullptr) {
+        return;
+      }
+      m_view = MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0);
+      if (m_view) {
+        m_size = size_t(fileSize.QuadPart);
+      }
+    }
+    ~MappedFile() {
+      if (m_view) {
+        UnmapViewOfFile(m_view);
+      }
+      if (m_mapping) {
+        CloseHandle(m_mapping);
+      }
+      if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+      }
+    }
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* GetData() const { return m_view; }
+    size_t GetSize() const { return m_size; }
+  private:
+    HANDLE m_file = INVALID_HANDLE_VALUE;
+    HANDLE m_mapping = nullptr;
+    void*  m_view = nullptr;
+    size_t m_size = 0;
+  };
+
+  void WriteModelCache(const fs::path& filePath, model::ModelLoadFlag loadFlags, const model::ModelSourceData& source) {
+    ModelCacheHeader header;
+    if (!MakeCacheHeader(filePath, loadFlags, header)) {
+      return;
+    }
+    // 書き込み途中のファイルを読まないよう一時ファイル経由で置き換える.
+    auto cachePath = GetCachePath(filePath);
+    auto tempPath = cachePath;
+    tempPath += ".tmp";
+    {
+      std::ofstream os(tempPath, std::ios::binary | std::ios::trunc);
+      if (!os) {
+        return;
+      }
+      CacheWriter writer(os);
+      writer.Write(header);
+
+      writer.WriteArray(source.position);
+      writer.WriteArray(source.normal);
+      writer.WriteArray(source.uv0);
+      writer.WriteArray(source.tangent);
+      writer.WriteArray(source.boneIndices);
+      writer.WriteArray(source.boneWeights);
+      writer.WriteArray(source.indices);
+      writer.WriteArray(source.meshlets.meshlets);
+      writer.WriteArray(source.meshlets.vertices);
+      writer.WriteArray(source.meshlets.triangles);
+
+      writer.Write(uint32_t(source.batches.size()));
+      for (const auto& batch : source.batches) {
+        writer.Write(batch.vertexOffsetCount);
+        writer.Write(batch.vertexCount);
+        writer.Write(batch.indexOffsetCount);
+        writer.Write(batch.indexCount);
+        writer.Write(batch.materialIndex);
+        writer.Write(batch.meshIndex);
+        writer.Write(batch.meshletOffset);
+        writer.Write(batch.meshletCount);
+        writer.WriteArray(batch.lods);
+        writer.WriteArray(batch.boneNodes);
+      }
+
+      writer.Write(uint32_t(source.nodes.size()));
+      for (const auto& node : source.nodes) {
+        writer.WriteString(node.name);
+        writer.Write(node.parent);
+        writer.Write(node.transform);
+        writer.Write(node.offsetMatrix);
+      }
+
+      writer.Write(uint32_t(source.materials.size()));
+      for (const auto& m : source.materials) {
+        writer.WriteString(m.albedoTexture);
+        writer.WriteString(m.specularTexture);
+        writer.Write(m.diffuse);
+        writer.Write(m.shininess);
+        writer.Write(m.ambient);
+      }
+      writer.Write(uint32_t(source.animations.size()));
+      for (const auto& clip : source.animations) {
+        writer.WriteString(clip.name);
+        writer.Write(clip.duration);
+        writer.WriteArray(clip.tracks);
+        writer.WriteArray(clip.positionTimes);
+        writer.WriteArray(clip.positionValues);
+        writer.WriteArray(clip.rotationTimes);
+        writer.WriteArray(clip.rotationValues);
+        writer.WriteArray(clip.scaleTimes);
+        writer.WriteArray(clip.scaleValues);
+      }
+      writer.Write(source.invGlobalTransform);
+      if (!os) {
+        return;
+      }
+    }
+    std::error_code ec;
+    fs::rename(tempPath, cachePath, ec);
+  }
+
+  bool ReadModelCache(const fs::path& filePath, model::ModelLoadFlag loadFlags, model::ModelSourceData& source) {
+    ModelCacheHeader expected;
+    if (!MakeCacheHeader(filePath, loadFlags, expected)) {
+      return false;
+    }
+    MappedFile file(GetCachePath(filePath));
+    if (file.GetData() == nullptr) {
+      return false;
+    }
+
+    CacheReader reader(file.GetData(), file.GetSize());
+    ModelCacheHeader header;
+    if (!reader.Read(header) || memcmp(&header, &expected, sizeof(header)) != 0) {
+      return false;
+    }
+
+    model::ModelSourceData data;
+    bool ok = true;
+    ok = ok && reader.ReadArray(data.position);
+    ok = ok && reader.ReadArray(data.normal);
+    ok = ok && reader.ReadArray(data.uv0);
+    ok = ok && reader.ReadArray(data.tangent);
+    ok = ok && reader.ReadArray(data.boneIndices);
+    ok = ok && reader.ReadArray(data.boneWeights);
+    ok = ok && reader.ReadArray(data.indices);
+    ok = ok && reader.ReadArray(data.meshlets.meshlets);
+    ok = ok && reader.ReadArray(data.meshlets.vertices);
+    ok = ok && reader.ReadArray(data.meshlets.triangles);
+
+    uint32_t count = 0;
+    ok = ok && reader.Read(count);
+    for (uint32_t i = 0; ok && i < count; ++i) {
+      model::ModelSourceData::Batch batch{};
+      ok = ok && reader.Read(batch.vertexOffsetCount);
+      ok = ok && reader.Read(batch.vertexCount);
+      ok = ok && reader.Read(batch.indexOffsetCount);
+      ok = ok && reader.Read(batch.indexCount);
+      ok = ok && reader.Read(batch.materialIndex);
+      ok = ok && reader.Read(batch.meshIndex);
+      ok = ok && reader.Read(batch.meshletOffset);
+      ok = ok && reader.Read(batch.meshletCount);
+      ok = ok && reader.ReadArray(batch.lods);
+      ok = ok && reader.ReadArray(batch.boneNodes);
+      data.batches.emplace_back(std::move(batch));
+    }
+
+    ok = ok && reader.Read(count);
+    for (uint32_t i = 0; ok && i < count; ++i) {
+      model::ModelSourceData::NodeInfo node{};
+      ok = ok && reader.ReadString(node.name);
+      ok = ok && reader.Read(node.parent);
+      ok = ok && reader.Read(node.transform);
+      ok = ok && reader.Read(node.offsetMatrix);
+      data.nodes.emplace_back(std::move(node));
+    }
+
+    ok = ok && reader.Read(count);
+    for (uint32_t i = 0; ok && i < count; ++i) {
+      model::ModelSourceData::MaterialInfo m{};
+      ok = ok && reader.ReadString(m.albedoTexture);
+      ok = ok && reader.ReadString(m.specularTexture);
+      ok = ok && reader.Read(m.diffuse);
+      ok = ok && reader.Read(m.shininess);
+      ok = ok && reader.Read(m.ambient);
+      data.materials.emplace_back(std::move(m));
+    }
+    ok = ok && reader.Read(count);
+    for (uint32_t i = 0; ok && i < count; ++i) {
+      animation::AnimationClip clip;
+      ok = ok && reader.ReadString(clip.name);
+      ok = ok && reader.Read(clip.duration);
+      ok = ok && reader.ReadArray(clip.tracks);
+      ok = ok && reader.ReadArray(clip.positionTimes);
+      ok = ok && reader.ReadArray(clip.positionValues);
+      ok = ok && reader.ReadArray(clip.rotationTimes);
+      ok = ok && reader.ReadArray(clip.rotationValues);
+      ok = ok && reader.ReadArray(clip.scaleTimes);
+      ok = ok && reader.ReadArray(clip.scaleValues);
+      data.animations.emplace_back(std::move(clip));
+    }
+    ok = ok && reader.Read(data.invGlobalTransform);
+    if (!ok || data.nodes.empty()) {
+      return false;
+    }
+    source = std::move(data);
+    return true;
+  }
+}
+
+namespace model {
+  ModelAsset LoadModelData(std::filesystem::path filePath, D3D12AppBase* appBase, ModelLoadFlag loadFlags) {
+    return CreateModelAsset(LoadModelSource(filePath, loadFlags), appBase, loadFlags);
+  }
+
+  ModelSourceData LoadModelSource(std::filesystem::path filePath, ModelLoadFlag loadFlags) {
+    ModelSourceData source;
+    bool cached = (loadFlags & ModelLoadFlag_UseCache) && ReadModelCache(filePath, loadFlags, source);
+    if (cached) {
+      if (!(loadFlags & ModelLoadFlag_CalcTangent)) {
+        source.tangent.clear();
+      } else if (source.tangent.empty()) {
+        // 接線無しで作られたキャッシュ. インポートし直さずに生成して書き戻す.
+        GenerateModelTangents(source);
+        WriteModelCache(filePath, loadFlags, source);
+      }
+    } else {
+      ImportModelSource(filePath.string(), loadFlags, source);
+      if (loadFlags & ModelLoadFlag_WeldVertices) {
+        WeldModelSource(filePath.string(), source);
+      }
+      if (loadFlags & ModelLoadFlag_CalcTangent) {
+        GenerateModelTangents(source);
+      }
+      if (loadFlags & ModelLoadFlag_OptimizeMesh) {
+        OptimizeModelSource(filePath.string(), source);
+      }
+      if (loadFlags & ModelLoadFlag_BuildMeshlets) {
+        BuildModelMeshlets(source);
+      }
+      if (loadFlags & ModelLoadFlag_GenerateLod) {
+        GenerateModelLods(filePath.string(), source);
+      }
+      if (loadFlags & ModelLoadFlag_UseCache) {
+        WriteModelCache(filePath, loadFlags, source);
+      }
+    }
+    if (loadFlags & ModelLoadFlag_BuildBvh) {
+      source.bvh = BuildModelBvh(source);
+    }
+    return source;
+  }
+
+  ModelLoadHandle::ModelLoadHandle(std::filesystem::path filePath, D3D12AppBase* appBase, ModelLoadFlag loadFlags)
+    : m_filePath(filePath), m_loadFlags(loadFlags) {
+    auto decoder = appBase->GetTextureDecoder();
+    // テクスチャの登録情報はメインスレッドのものなので, ここで写しておく.
+    auto loadedKeys = appBase->GetLoadedTextureKeys();
+    m_source = std::async(std::launch::async, [filePath, loadFlags, decoder, loadedKeys]() {
+      auto source = LoadModelSource(filePath, loadFlags);
+      // デコードの完了まで待ち, TryFinish の LoadTexture で描画スレッドが止まらないようにする.
+      // 失敗した場合の例外は LoadTexture で送出される.
+      for (const auto& request : RequestMaterialTextures(source, *decoder, loadedKeys)) {
+        request.wait();
+      }
+      return source;
+    });
+  }
+
+  bool ModelLoadHandle::IsReady() const {
+    if (!m_source.valid()) {
+      return false;
+    }
+    return m_source.wait_for(std::chrono::seconds(0)) == std::future_status::ready;
+  }
+
+  bool ModelLoadHandle::TryFinish(D3D12AppBase* appBase, ComPtr<ID3D12GraphicsCommandList> commandList, ModelAsset& asset) {
+    if (m_finished || !IsReady()) {
+      return false;
+    }
+    // get() で future は無効になるので, 例外が出ても 2 度目は呼ばれない.
+    m_finished = true;
+    auto source = m_source.get();
+    // 差し替え前のモデルは描画中かもしれないので遅延解放する.
+    asset.Release(*appBase->GetReleaseQueue());
+    asset = CreateModelAsset(source, appBase, m_loadFlags, commandList);
+    return true;
+  }
+
+  std::shared_ptr<ModelLoadHandle> LoadModelDataAsync(std::filesystem::path filePath, D3D12AppBase* appBase, ModelLoadFlag loadFlags) {
+    return std::make_shared<ModelLoadHandle>(filePath, appBase, loadFlags);
+  }
+
+  ModelAsset CreateModelAsset(const ModelSourceData& source, D3D12AppBase* appBase, ModelLoadFlag loadFlags,
+    ComPtr<ID3D12GraphicsCommandList> commandList) {
+    ModelAsset model;
+    const auto& vbPos = source.position;
+    const auto& vbNrm = source.normal;
+    const auto& vbUV0 = source.uv0;
+    const auto& vbTangents = source.tangent;
+    const auto& vbBIndices = source.boneIndices;
+    const auto& vbBWeights = source.boneWeights;
+    const auto& ibIndices = source.indices;
+    UINT totalVertexCount = UINT(vbPos.size());
+    UINT totalIndexCount = UINT(ibIndices.size());
+    bool hasBone = !vbBIndices.empty();
+    bool hasTangent = !vbTangents.empty();
+
+    // ノード階層の復元.
+    for (const auto& info : source.nodes) {
+      model.skeleton.AddNode(info.name, info.parent, info.transform, info.offsetMatrix);
+    }
+
+    std::vector<int> nodePaletteIndices(source.nodes.size(), -1);
+    for (const auto& src : source.batches) {
+      DrawBatch batch{};
+      batch.vertexOffsetCount = src.vertexOffsetCount;
+      batch.vertexCount = src.vertexCount;
+      batch.indexOffsetCount = src.indexOffsetCount;
+      batch.indexCount = src.indexCount;
+      batch.materialIndex = src.materialIndex;
+      batch.meshletOffset = src.meshletOffset;
+      batch.meshletCount = src.meshletCount;
+      batch.lods = src.lods;
+
+      // カリング用の AABB と LOD 選択用のバウンディング球.
+      if (src.vertexCount > 0) {
+        auto begin = source.position.begin() + src.vertexOffsetCount;
+        auto end = begin + src.vertexCount;
+        XMVECTOR bbMin = XMVectorReplicate(FLT_MAX), bbMax = XMVectorReplicate(-FLT_MAX);
+        std::for_each(begin, end, [&](const XMFLOAT3& p) {
+          auto v = XMLoadFloat3(&p);
+          bbMin = XMVectorMin(bbMin, v);
+          bbMax = XMVectorMax(bbMax, v);
+        });
+        auto center = (bbMin + bbMax) * 0.5f;
+        float radius = 0.0f;
+        std::for_each(begin, end, [&](const XMFLOAT3& p) {
+          radius = std::max(radius, XMVectorGetX(XMVector3Length(XMLoadFloat3(&p) - center)));
+        });
+        XMStoreFloat4(&batch.boundingSphere, XMVectorSetW(center, radius));
+        XMStoreFloat3(&batch.aabbCenter, center);
+        XMStoreFloat3(&batch.aabbExtents, (bbMax - bbMin) * 0.5f);
+      }
+      model.batchBounds.Add(batch.aabbCenter, batch.aabbExtents);
+
+      // 複数のバッチで使われるボーンはパレット内の同じ要素を参照させる.
+      for (auto nodeIndex : src.boneNodes) {
+        auto& paletteIndex = nodePaletteIndices[nodeIndex];
+        if (paletteIndex < 0) {
+          paletteIndex = int(model.bonePaletteNodes.size());
+          model.bonePaletteNodes.push_back(nodeIndex);
+        }
+        batch.boneRemap.push_back(UINT(paletteIndex));
+      }
+      if (hasBone && batch.boneRemap.empty()) {
+        DebugBreak();
+      }
+      model.DrawBatches.emplace_back(batch);
+    }
+    if (!model.bonePaletteNodes.empty()) {
+      if (model.bonePaletteNodes.size() > ModelAsset::MaxBonePaletteCount) {
+        throw std::runtime_error("Too many bones in model.");
+      }
+    }
+
+    // 全テクスチャのデコードを先に予約してワーカーで並列に進め, 作成とアップロードはここで順に行う.
+    RequestMaterialTextures(source, *appBase->GetTextureDecoder(), appBase->GetLoadedTextureKeys());
+    for (const auto& info : source.materials) {
+      Material m{};
+      auto albedo = appBase->LoadTexture(GetAlbedoTextureName(info), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, commandList);
+      m.albedoSRV = albedo.srv;
+      auto specular = appBase->LoadTexture(GetSpecularTextureName(info), D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, commandList);
+      m.specularSRV = specular.srv;
+      m.shininess = info.shininess;
+      m.diffuse = info.diffuse;
+      m.ambient = info.ambient;
+
+      model.materials.push_back(m);
+    }
+    model.totalVertexCount = totalVertexCount;
+    model.totalIndexCount = totalIndexCount;
+    model.meshlets = source.meshlets;
+    if (loadFlags & ModelLoadFlag_CompressAnimation) {
+      // 許容誤差はモデルの大きさの 0.01%.
+      float modelRadius = 0.0f;
+      for (const auto& batch : model.DrawBatches) {
+        auto center = XMLoadFloat4(&batch.boundingSphere);
+        modelRadius = std::max(modelRadius, XMVectorGetX(XMVector3Length(center)) + batch.boundingSphere.w);
+      }
+      size_t rawSize = 0, compressedSize = 0;
+      for (const auto& clip : source.animations) {
+        model.compressedAnimations.emplace_back(animation::CompressClip(clip, model.skeleton, modelRadius * 1.0e-4f));
+        rawSize += animation::GetMemorySize(clip);
+        compressedSize += animation::GetMemorySize(model.compressedAnimations.back());
+      }
+      if (!source.animations.empty()) {
+        char buf[256];
+        sprintf_s(buf, "Animation clips: %zu bytes -> %zu bytes\n", rawSize, compressedSize);
+        OutputDebugStringA(buf);
+      }
+    } else {
+      model.animations = source.animations;
+    }
+
+    // 通常は DEFAULT ヒープに配置し, ステージング用の UPLOAD ヒープからまとめてコピーする.
+    // ModelLoadFlag_DynamicBuffer 指定時は CPU から書き換えられるよう UPLOAD ヒープへ直接置く.
+    bool isDynamic = (loadFlags & ModelLoadFlag_DynamicBuffer) != 0;
+    struct StagingCopy {
+      Buffer dst;
+      Buffer src;
+      D3D12_RESOURCE_STATES afterState;
+    };
+    std::vector<StagingCopy> stagingCopies;
+    auto createStaticBuffer = [&](Buffer& buffer, const void* data, UINT bufferSize, D3D12_RESOURCE_STATES afterState) {
+      auto desc = CD3DX12_RESOURCE_DESC::Buffer(bufferSize);
+      if (isDynamic) {
+        buffer = appBase->CreateResource(desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, D3D12_HEAP_TYPE_UPLOAD);
+        appBase->WriteToUploadHeapMemory(buffer.Get(), bufferSize, data);
+        return;
+      }
+      buffer = appBase->CreateResource(desc, D3D12_RESOURCE_STATE_COPY_DEST, nullptr, D3D12_HEAP_TYPE_DEFAULT);
+      if (!commandList) {
+        // コピーキューでまとめて転送する. 完了後は COMMON に戻り, 使用時に暗黙に昇格する.
+        appBase->GetUploadManager()->UploadBuffer(buffer.Get(), 0, data, bufferSize);
+        return;
+      }
+      auto staging = appBase->CreateResource(desc, D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, D3D12_HEAP_TYPE_UPLOAD);
+      appBase->WriteToUploadHeapMemory(staging.Get(), bufferSize, data);
+      stagingCopies.push_back({ buffer, staging, afterState });
+    };
+
+    auto createVertexBuffer = [&](ModelAsset::VBViewType type, Buffer& buffer, const void* data, UINT stride, DXGI_FORMAT format) {
+      auto bufferSize = stride * totalVertexCount;
+      createStaticBuffer(buffer, data, bufferSize, D3D12_RESOURCE_STATE_VERTEX_AND_CONSTANT_BUFFER);
+      model.vertexBufferViews[type] = { buffer->GetGPUVirtualAddress(), bufferSize, stride };
+      model.vertexFormats[type] = format;
+    };
+
+    if (loadFlags & ModelLoadFlag_QuantizeVertex) {
+      // 位置はバッチの AABB で正規化した 16bit, 法線/接線は八面体エンコード,
+      // UV は半精度, ボーンは 8bit インデックスと UNORM8 ウェイトで格納.
+      model.isQuantized = true;
+      std::vector<XMUSHORTN4> positions(totalVertexCount);
+      std::vector<XMSHORTN2> normals(totalVertexCount);
+      std::vector<XMHALF2> uv0(totalVertexCount);
+      for (auto& batch : model.DrawBatches) {
+        auto begin = vbPos.begin() + batch.vertexOffsetCount;
+        auto end = begin + batch.vertexCount;
+        XMVECTOR bbMin = XMVectorReplicate(FLT_MAX), bbMax = XMVectorReplicate(-FLT_MAX);
+        std::for_each(begin, end, [&](const XMFLOAT3& p) {
+          auto v = XMLoadFloat3(&p);
+          bbMin = XMVectorMin(bbMin, v);
+          bbMax = XMVectorMax(bbMax, v);
+        });
+        if (batch.vertexCount == 0) {
+          bbMin = bbMax = XMVectorZero();
+        }
+        // 大きさ 0 の軸で除算しないように最小値を設ける.
+        auto scale = XMVectorMax(bbMax - bbMin, XMVectorReplicate(1.0e-6f));
+        XMStoreFloat4(&batch.positionScale, XMVectorSetW(scale, 0.0f));
+        XMStoreFloat4(&batch.positionBias, XMVectorSetW(bbMin, 0.0f));
+
+        auto invScale = XMVectorReciprocal(scale);
+        for (UINT i = batch.vertexOffsetCount; i < batch.vertexOffsetCount + batch.vertexCount; ++i) {
+          XMFLOAT3 unorm;
+          XMStoreFloat3(&unorm, (XMLoadFloat3(&vbPos[i]) - bbMin) * invScale);
+          positions[i] = QuantizeUNorm16(unorm);
+        }
+      }
+      for (UINT i = 0; i < totalVertexCount; ++i) {
+        normals[i] = EncodeOctahedral(vbNrm[i]);
+        uv0[i] = XMHALF2(vbUV0[i].x, vbUV0[i].y);
+      }
+      createVertexBuffer(ModelAsset::VBV_Position, model.Position, positions.data(), sizeof(XMUSHORTN4), DXGI_FORMAT_R16G16B16A16_UNORM);
+      createVertexBuffer(ModelAsset::VBV_Normal, model.Normal, normals.data(), sizeof(XMSHORTN2), DXGI_FORMAT_R16G16_SNORM);
+      createVertexBuffer(ModelAsset::VBV_UV0, model.UV0, uv0.data(), sizeof(XMHALF2), DXGI_FORMAT_R16G16_FLOAT);
+
+      if (hasTangent) {
+        // 従法線の向きを w に残すため, 八面体ではなく 4 成分の SNORM8 にする.
+        std::vector<XMBYTEN4> tangents(totalVertexCount);
+        for (UINT i = 0; i < totalVertexCount; ++i) {
+          XMStoreByteN4(&tangents[i], XMLoadFloat4(&vbTangents[i]));
+        }
+        createVertexBuffer(ModelAsset::VBV_Tangent, model.Tangent, tangents.data(), sizeof(XMBYTEN4), DXGI_FORMAT_R8G8B8A8_SNORM);
+      }
+      if (hasBone) {
+        // パレットが 256 本を超えるバッチがあれば 16bit インデックスにする.
+        bool fitsInByte = std::all_of(vbBIndices.begin(), vbBIndices.end(), [](const XMINT4& v) {
+          return v.x < 256 && v.y < 256 && v.z < 256 && v.w < 256;
+        });
+        if (fitsInByte) {
+          std::vector<XMUBYTE4> indices(totalVertexCount);
+          for (UINT i = 0; i < totalVertexCount; ++i) {
+            const auto& v = vbBIndices[i];
+            indices[i] = XMUBYTE4(uint8_t(v.x), uint8_t(v.y), uint8_t(v.z), uint8_t(v.w));
+          }
+          createVertexBuffer(ModelAsset::VBV_BlendIndices, model.BoneIndices, indices.data(), sizeof(XMUBYTE4), DXGI_FORMAT_R8G8B8A8_UINT);
+        } else {
+          std::vector<XMUSHORT4> indices(totalVertexCount);
+          for (UINT i = 0; i < totalVertexCount; ++i) {
+            const auto& v = vbBIndices[i];
+            indices[i] = XMUSHORT4(uint16_t(v.x), uint16_t(v.y), uint16_t(v.z), uint16_t(v.w));
+          }
+          createVertexBuffer(ModelAsset::VBV_BlendIndices, model.BoneIndices, indices.data(), sizeof(XMUSHORT4), DXGI_FORMAT_R16G16B16A16_UINT);
+        }
+
+        std::vector<XMUBYTEN4> weights(totalVertexCount);
+        for (UINT i = 0; i < totalVertexCount; ++i) {
+          weights[i] = QuantizeWeights(vbBWeights[i]);
+        }
+        createVertexBuffer(ModelAsset::VBV_BlendWeights, model.BoneWeights, weights.data(), sizeof(XMUBYTEN4), DXGI_FORMAT_R8G8B8A8_UNORM);
+      }
+    } else {
+      createVertexBuffer(ModelAsset::VBV_Position, model.Position, vbPos.data(), sizeof(XMFLOAT3), DXGI_FORMAT_R32G32B32_FLOAT);
+      createVertexBuffer(ModelAsset::VBV_Normal, model.Normal, vbNrm.data(), sizeof(XMFLOAT3), DXGI_FORMAT_R32G32B32_FLOAT);
+      createVertexBuffer(ModelAsset::VBV_UV0, model.UV0, vbUV0.data(), sizeof(XMFLOAT2), DXGI_FORMAT_R32G32_FLOAT);
+      if (hasTangent) {
+        createVertexBuffer(ModelAsset::VBV_Tangent, model.Tangent, vbTangents.data(), sizeof(XMFLOAT4), DXGI_FORMAT_R32G32B32A32_FLOAT);
+      }
+      if (hasBone) {
+        createVertexBuffer(ModelAsset::VBV_BlendIndices, model.BoneIndices, vbBIndices.data(), sizeof(XMINT4), DXGI_FORMAT_R32G32B32A32_UINT);
+        createVertexBuffer(ModelAsset::VBV_BlendWeights, model.BoneWeights, vbBWeights.data(), sizeof(XMFLOAT4), DXGI_FORMAT_R32G32B32A32_FLOAT);
+      }
+    }
+
+    // インデックスはバッチローカルなので, 頂点数が 65536 以下のバッチは 16bit で格納する.
+    // 前半に 16bit のバッチ, 後半に 32bit のバッチをまとめ, バッチごとに自身の領域を指すビューを持たせる.
+    const UINT MaxIndex16VertexCount = 65536;
+    auto copyBatchIndices = [&](DrawBatch& batch, auto& dst) {
+      using IndexType = typename std::decay_t<decltype(dst)>::value_type;
+      auto copyRange = [&](UINT& indexOffsetCount, UINT indexCount) {
+        auto begin = ibIndices.begin() + indexOffsetCount;
+        indexOffsetCount = UINT(dst.size());
+        std::transform(begin, begin + indexCount, std::back_inserter(dst), [](UINT v) { return IndexType(v); });
+      };
+      copyRange(batch.indexOffsetCount, batch.indexCount);
+      // lods[0] はベースと同じ範囲.
+      for (size_t i = 0; i < batch.lods.size(); ++i) {
+        if (i == 0) {
+          batch.lods[i].indexOffsetCount = batch.indexOffsetCount;
+        } else {
+          copyRange(batch.lods[i].indexOffsetCount, batch.lods[i].indexCount);
+        }
+      }
+    };
+    std::vector<uint16_t> indices16;
+    std::vector<uint32_t> indices32;
+    for (auto& batch : model.DrawBatches) {
+      if (batch.vertexCount <= MaxIndex16VertexCount) {
+        copyBatchIndices(batch, indices16);
+      } else {
+        copyBatchIndices(batch, indices32);
+      }
+    }
+    // 32bit 領域の開始位置を 4 バイト境界に揃える.
+    if (indices16.size() % 2) {
+      indices16.push_back(0);
+    }
+    auto size16 = UINT(sizeof(uint16_t) * indices16.size());
+    auto size32 = UINT(sizeof(uint32_t) * indices32.size());
+    {
+      std::vector<uint8_t> work(std::max(size16 + size32, 4u));
+      if (size16) {
+        memcpy(work.data(), indices16.data(), size16);
+      }
+      if (size32) {
+        memcpy(work.data() + size16, indices32.data(), size32);
+      }
+      createStaticBuffer(model.Indices, work.data(), UINT(work.size()), D3D12_RESOURCE_STATE_INDEX_BUFFER);
+    }
+
+    // 呼び出し側のコマンドリストが渡された場合は全ストリームのコピーをそこへ積み, ステージングは appBase に預ける.
+    // それ以外はアップロードマネージャに積んであり, D3D12AppBase::FlushUploads で発行される.
+    if (!stagingCopies.empty()) {
+      std::vector<D3D12_RESOURCE_BARRIER> barriers;
+      for (const auto& copy : stagingCopies) {
+        commandList->CopyResource(copy.dst.Get(), copy.src.Get());
+        barriers.push_back(CD3DX12_RESOURCE_BARRIER::Transition(
+          copy.dst.Get(), D3D12_RESOURCE_STATE_COPY_DEST, copy.afterState));
+        appBase->DelayRelease(copy.src);
+      }
+      commandList->ResourceBarrier(UINT(barriers.size()), barriers.data());
+      stagingCopies.clear();
+    }
+    auto ibAddress = model.Indices->GetGPUVirtualAddress();
+    for (auto& batch : model.DrawBatches) {
+      if (batch.vertexCount <= MaxIndex16VertexCount) {
+        batch.indexBufferView = { ibAddress, size16, DXGI_FORMAT_R16_UINT };
+      } else {
+        batch.indexBufferView = { ibAddress + size16, size32, DXGI_FORMAT_R32_UINT };
+      }
+    }
+    model.indexBufferSize = size16 + size32;
+
+    model.invGlobalTransform = XMLoadFloat4x4(&source.invGlobalTransform);
+    if (loadFlags & ModelLoadFlag_BuildBvh) {
+      // 通常は LoadModelSource で構築済み.
+      model.bvh = source.bvh ? source.bvh : BuildModelBvh(source);
+    }
+    if (loadFlags & ModelLoadFlag_KeepCpuData) {
+      model.cpuData = std::make_shared<ModelSourceData>(source);
+    }
+    OutputDebugStringA(model.GetMemoryStats().ToString().c_str());
+    return model;
+  }
+
+  size_t ModelMemoryStats::GetTotalCpuBytes() const {
+    size_t total = 0;
+    for (const auto& e : entries) {
+      total += e.cpuBytes;
+    }
+    return total;
+  }
+
+  size_t ModelMemoryStats::GetTotalGpuBytes() const {
+    size_t total = 0;
+    for (const auto& e : entries) {
+      total += e.gpuBytes;
+    }
+    return total;
+  }
+
+  std::string ModelMemoryStats::ToString() const {
+    std::string result;
+    char buf[256];
+    sprintf_s(buf, "%-14s %12s %12s\n", "Model memory", "CPU(KB)", "GPU(KB)");
+    result += buf;
+    for (const auto& e : entries) {
+      sprintf_s(buf, "  %-12s %12.1f %12.1f\n", e.name, e.cpuBytes / 1024.0, e.gpuBytes / 1024.0);
+      result += buf;
+    }
+    sprintf_s(buf, "  %-12s %12.1f %12.1f\n", "Total", GetTotalCpuBytes() / 1024.0, GetTotalGpuBytes() / 1024.0);
+    result += buf;
+    return result;
+  }
+
+  ModelMemoryStats ModelAsset::GetMemoryStats() const {
+    // コミットされたバッファは 64KB 単位で確保されるため, その大きさで数える.
+    auto gpuSize = [](const Buffer& buffer) -> size_t {
+      if (!buffer) {
+        return 0;
+      }
+      const UINT64 align = D3D12_DEFAULT_RESOURCE_PLACEMENT_ALIGNMENT;
+      return size_t((buffer->GetDesc().Width + align - 1) & ~(align - 1));
+    };
+    auto cpuSize = [](const auto& v) -> size_t {
+      return sizeof(v[0]) * v.size();
+    };
+    auto meshletSize = [&](const meshlet::MeshletData& data) {
+      return cpuSize(data.meshlets) + cpuSize(data.vertices) + cpuSize(data.triangles);
+    };
+
+    ModelMemoryStats stats;
+    auto* cpu = cpuData.get();
+    stats.entries.push_back({ "Position", cpu ? cpuSize(cpu->position) : 0, gpuSize(Position) });
+    stats.entries.push_back({ "Normal", cpu ? cpuSize(cpu->normal) : 0, gpuSize(Normal) });
+    stats.entries.push_back({ "UV0", cpu ? cpuSize(cpu->uv0) : 0, gpuSize(UV0) });
+    stats.entries.push_back({ "Tangent", cpu ? cpuSize(cpu->tangent) : 0, gpuSize(Tangent) });
+    stats.entries.push_back({ "BoneIndices", cpu ? cpuSize(cpu->boneIndices) : 0, gpuSize(BoneIndices) });
+    stats.entries.push_back({ "BoneWeights", cpu ? cpuSize(cpu->boneWeights) : 0, gpuSize(BoneWeights) });
+    stats.entries.push_back({ "Indices", cpu ? cpuSize(cpu->indices) : 0, gpuSize(Indices) });
+
+    size_t batchBytes = cpuSize(DrawBatches);
+    for (const auto& batch : DrawBatches) {
+      batchBytes += cpuSize(batch.lods) + cpuSize(batch.boneRemap);
+    }
+    stats.entries.push_back({ "Batches", batchBytes, 0 });
+    stats.entries.push_back({ "Meshlets", meshletSize(meshlets) + (cpu ? meshletSize(cpu->meshlets) : 0), 0 });
+    stats.entries.push_back({ "Skeleton", skeleton.GetMemorySize() + cpuSize(bonePaletteNodes), 0 });
+
+    size_t animationBytes = 0;
+    for (const auto& clip : animations) {
+      animationBytes += animation::GetMemorySize(clip);
+    }
+    for (const auto& clip : compressedAnimations) {
+      animationBytes += animation::GetMemorySize(clip);
+    }
+    if (cpu) {
+      for (const auto& clip : cpu->animations) {
+        animationBytes += animation::GetMemorySize(clip);
+      }
+    }
+    stats.entries.push_back({ "Animations", animationBytes, 0 });
+    stats.entries.push_back({ "Materials", cpuSize(materials), 0 });
+
+    size_t extraBytes = 0;
+    for (const auto& extra : extraBuffers) {
+      extraBytes += gpuSize(extra.second);
+    }
+    stats.entries.push_back({ "Bvh", bvh ? bvh->GetMemorySize() : 0, 0 });
+    stats.entries.push_back({ "Extra", 0, extraBytes });
+    return stats;
+  }
+
+  D3D12_GPU_VIRTUAL_ADDRESS ModelAsset::UpdateBonePalette(UploadRingBuffer& ring) const {
+    if (bonePaletteNodes.empty()) {
+      return 0;
+    }
+    auto alloc = ring.Allocate(sizeof(XMFLOAT4X4) * bonePaletteNodes.size());
+    auto mapped = static_cast<XMFLOAT4X4*>(alloc.cpuAddress);
+    for (size_t i = 0; i < bonePaletteNodes.size(); ++i) {
+      XMStoreFloat4x4(&mapped[i], XMMatrixTranspose(GetBoneMatrix(i)));
+    }
+    return alloc.gpuAddress;
+  }
+
+  XMMATRIX ModelAsset::GetBoneMatrix(size_t paletteIndex) const {
+    auto node = bonePaletteNodes[paletteIndex];
+    auto mtx = XMMatrixMultiply(skeleton.GetOffsetMatrix(node), skeleton.GetWorldTransform(node));
+    return XMMatrixMultiply(mtx, invGlobalTransform);
+  }
+
+  UINT ModelAsset::GetBatchFromTriangle(UINT triangle) const {
+    for (UINT i = 0; i < UINT(DrawBatches.size()); ++i) {
+      auto count = DrawBatches[i].indexCount / 3;
+      if (triangle < count) {
+        return i;
+      }
+      triangle -= count;
+    }
+    return UINT(DrawBatches.size());
+  }
+
+  void ModelAsset::Release() {
+    Position = nullptr;
+    Normal = nullptr; 
+    UV0 = nullptr;
+    BoneIndices = nullptr; 
+    BoneWeights = nullptr;
+    Tangent = nullptr;
+    Indices = nullptr;
+
+    DrawBatches.clear();
+    batchBounds.Clear();
+    bonePaletteNodes.clear();
+    meshlets = meshlet::MeshletData();
+    extraBuffers.clear();
+    extraHandles.clear();
+    skeleton.Clear();
+    animations.clear();
+    compressedAnimations.clear();
+    cpuData.reset();
+    bvh.reset();
+  }
+
+  void ModelAsset::Release(DeferredReleaseQueue& queue) {
+    for (auto buffer : { Position, Normal, UV0, BoneIndices, BoneWeights, Tangent, Indices }) {
+      queue.Release(buffer);
+    }
+    for (const auto& batch : DrawBatches) {
+      for (const auto& cb : batch.materialParameterCB) {
+        queue.Release(cb);
+      }
+    }
+    for (const auto& v : extraBuffers) {
+      queue.Release(v.second);
+    }
+    Release();
+  }
+
 }
\ No newline at end of file
@@ -1,96 +1,257 @@
-#pragma once
-
-#include <DirectXMath.h>
-#include <vector>
-#include <string>
-#include <memory>
-#include <unordered_map>
-#include <filesystem>
-
-#include "D3D12AppBase.h"
-
-struct aiBone;
-struct aiScene;
-namespace Assimp {
-  class Importer;
-}
-
-
-namespace model {
-  using Buffer = D3D12AppBase::Buffer;
-
-  struct Node {
-    std::vector<std::shared_ptr<Node>> children;
-    DirectX::XMMATRIX  transform = DirectX::XMMatrixIdentity();
-    DirectX::XMMATRIX  worldTransform = DirectX::XMMatrixIdentity();
-    DirectX::XMMATRIX  offsetMatrix = DirectX::XMMatrixIdentity();
-    std::string name;
-
-    Node() = default;
-
-    void UpdateMatrices(DirectX::XMMATRIX mtxParent);
-  };
-
-  struct Material {
-    DescriptorHandle albedoSRV;
-    DescriptorHandle specularSRV;
-
-    DirectX::XMFLOAT3 diffuse;
-    float shininess = 0;
-    DirectX::XMFLOAT3 ambient;
-  };
-
-  struct DrawBatch {
-    UINT vertexOffsetCount;
-    UINT indexCount;
-    UINT indexOffsetCount;
-    UINT materialIndex;
-
-    std::vector<aiBone*> boneList;
-    std::vector<std::shared_ptr<Node>> boneList2;
-    std::vector<Buffer>  boneMatrixPalette;
-    std::vector<Buffer>  materialParameterCB;
-  };
-
-  struct ModelAsset {
-    Buffer Position, Normal, UV0;
-    Buffer BoneIndices, BoneWeights;
-    Buffer Tangent;
-    Buffer Indices;
-
-    std::vector<DrawBatch> DrawBatches;
-    Assimp::Importer* importer;
-    const aiScene* scene;
-    UINT   totalVertexCount;
-    UINT   totalIndexCount;
-
-    DirectX::XMMATRIX invGlobalTransform;
-    std::shared_ptr<Node> rootNode;
-    std::vector<Material> materials;
-
-    void Release();
-    std::shared_ptr<Node> FindNode(const std::string& name);
-
-    enum VBViewType {
-      VBV_Position = 0,
-      VBV_Normal,
-      VBV_UV0,
-      VBV_BlendIndices,
-      VBV_BlendWeights,
-      VBV_Tangent,
-    };
-    std::unordered_map<VBViewType, D3D12_VERTEX_BUFFER_VIEW> vertexBufferViews;
-    D3D12_INDEX_BUFFER_VIEW indexBufferView;
-
-    // ֘AtĕێĂgobt@Ȃ.
-    std::unordered_map<std::string, Buffer> extraBuffers;
-    std::unordered_map<std::string, DescriptorHandle> extraHandles;
-  };
-
-  enum ModelLoadFlag {
-    ModelLoadFlag_None = 0,
-    ModelLoadFlag_Flip_UV =     1u << 0,
-    ModelLoadFlag_CalcTangent=  1u << 1,
-  };
-  ModelAsset LoadModelData(std::filesystem::path filePath, D3D12AppBase* appBase, ModelLoadFlag loadFlags = ModelLoadFlag_None);
-}
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <filesystem>
+#include <future>
+
+#include "D3D12AppBase.h"
+#include "Meshlet.h"
+#include "Culling.h"
+#include "TriangleBvh.h"
+#include "Skeleton.h"
+#include "Animation.h"
+
+namespace model {
+  using Buffer = D3D12AppBase::Buffer;
+  template<class T>
+  using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+  struct Material {
+    DescriptorHandle albedoSRV;
+    DescriptorHandle specularSRV;
+
+    DirectX::XMFLOAT3 diffuse;
+    float shininess = 0;
+    DirectX::XMFLOAT3 ambient;
+  };
+
+  // 簡略化した LOD のインデックス範囲. 頂点はベースと共有する.
+  struct LodLevel {
+    UINT indexOffsetCount;
+    UINT indexCount;
+    float error;    // バッチ半径に対する相対誤差.
+  };
+
+  struct DrawBatch {
+    UINT vertexOffsetCount;
+    UINT vertexCount;
+    UINT indexCount;
+    UINT indexOffsetCount;    // indexBufferView 内の開始位置.
+    UINT materialIndex;
+    UINT meshletOffset = 0;   // ModelAsset::meshlets 内の範囲.
+    UINT meshletCount = 0;
+    std::vector<LodLevel> lods;  // [0] がベース. ModelLoadFlag_GenerateLod 指定時のみ.
+    DirectX::XMFLOAT4 boundingSphere = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f); // xyz: 中心, w: 半径.
+    DirectX::XMFLOAT3 aabbCenter = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);   // モデル空間の AABB.
+    DirectX::XMFLOAT3 aabbExtents = DirectX::XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+    // 画面上のバウンディング球の半径 (ピクセル) から, 誤差が maxErrorPx 以下となる最も粗い LOD を選ぶ.
+    UINT SelectLod(float projectedSizePx, float maxErrorPx = 1.0f) const {
+      UINT level = 0;
+      for (UINT i = 1; i < UINT(lods.size()); ++i) {
+        if (lods[i].error * projectedSizePx <= maxErrorPx) {
+          level = i;
+        }
+      }
+      return level;
+    }
+    LodLevel GetLod(UINT level) const {
+      if (level < lods.size()) {
+        return lods[level];
+      }
+      return LodLevel{ indexOffsetCount, indexCount, 0.0f };
+    }
+
+    // 頂点数に応じて R16/R32 を選んだ, このバッチ用のインデックスバッファビュー.
+    D3D12_INDEX_BUFFER_VIEW indexBufferView{};
+
+    // 量子化頂点の位置復元用パラメータ (position = encoded * scale + bias).
+    DirectX::XMFLOAT4 positionScale = DirectX::XMFLOAT4(1.0f, 1.0f, 1.0f, 0.0f);
+    DirectX::XMFLOAT4 positionBias = DirectX::XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+
+    std::vector<UINT>    boneRemap;   // バッチ内のボーン番号 -> ボーンパレット内の番号.
+    std::vector<Buffer>  materialParameterCB;
+  };
+
+  // Assimp から取り出した CPU 側のモデルデータ.
+  // キャッシュファイルにはこの内容がそのまま書き出される.
+  struct ModelSourceData {
+    struct Batch {
+      UINT vertexOffsetCount;
+      UINT vertexCount;
+      UINT indexOffsetCount;
+      UINT indexCount;
+      UINT materialIndex;
+      UINT meshIndex;
+      UINT meshletOffset;
+      UINT meshletCount;
+      std::vector<LodLevel> lods;
+      std::vector<int> boneNodes;  // 有効ボーンに対応するノード番号.
+    };
+    struct NodeInfo {
+      std::string name;
+      int parent;   // 親ノード番号 (ルートは -1).
+      DirectX::XMFLOAT4X4 transform;
+      DirectX::XMFLOAT4X4 offsetMatrix;
+    };
+    struct MaterialInfo {
+      std::string albedoTexture;    // 空ならデフォルトテクスチャ.
+      std::string specularTexture;
+      DirectX::XMFLOAT3 diffuse;
+      float shininess;
+      DirectX::XMFLOAT3 ambient;
+    };
+
+    std::vector<DirectX::XMFLOAT3> position, normal;
+    std::vector<DirectX::XMFLOAT2> uv0;
+    std::vector<DirectX::XMFLOAT4> tangent;   // w は従法線の向き (binormal = cross(normal, tangent) * w).
+    std::vector<DirectX::XMINT4>   boneIndices;
+    std::vector<DirectX::XMFLOAT4> boneWeights;
+    std::vector<UINT> indices;
+    meshlet::MeshletData meshlets;
+
+    std::vector<Batch> batches;
+    std::vector<NodeInfo> nodes;  // 親が必ず先に来る順序.
+    std::vector<MaterialInfo> materials;
+    std::vector<animation::AnimationClip> animations;
+    DirectX::XMFLOAT4X4 invGlobalTransform;
+
+    // ModelLoadFlag_BuildBvh 指定時のみ. 読み込みスレッドで構築する. キャッシュには含めない.
+    std::shared_ptr<const bvh::TriangleBvh> bvh;
+  };
+
+  // ModelAsset が保持しているメモリ量. ストリームごとに CPU/GPU のバイト数を持つ.
+  struct ModelMemoryStats {
+    struct Entry {
+      const char* name;
+      size_t cpuBytes;
+      size_t gpuBytes;
+    };
+    std::vector<Entry> entries;
+
+    size_t GetTotalCpuBytes() const;
+    size_t GetTotalGpuBytes() const;
+    // 表形式の文字列にする. デバッグ出力用.
+    std::string ToString() const;
+  };
+
+  // 描画とアニメーションに必要なものだけを持つ実行時のモデル.
+  // Assimp のシーンは読み込み完了時に解放される.
+  struct ModelAsset {
+    Buffer Position, Normal, UV0;
+    Buffer BoneIndices, BoneWeights;
+    Buffer Tangent;
+    Buffer Indices;
+
+    std::vector<DrawBatch> DrawBatches;
+    culling::BoundsList batchBounds;  // DrawBatches と同じ順序の AABB. 視錐台カリング用.
+    UINT   totalVertexCount;
+    UINT   totalIndexCount;
+
+    DirectX::XMMATRIX invGlobalTransform;
+    Skeleton skeleton;
+    std::vector<animation::AnimationClip> animations;  // トラックは skeleton のノード番号を参照する.
+    std::vector<animation::CompressedClip> compressedAnimations;  // ModelLoadFlag_CompressAnimation 指定時は animations の代わりにこちら.
+
+    // CPU でのスキニングや当たり判定用. インデックスの位置は cpuData->batches を参照すること.
+    std::shared_ptr<const ModelSourceData> cpuData;
+
+    // ModelLoadFlag_BuildBvh 指定時のみ. モデル空間の三角形 BVH.
+    // 三角形番号は DrawBatches の順に各バッチの基本 LOD の三角形を並べたもの.
+    std::shared_ptr<const bvh::TriangleBvh> bvh;
+    // bvh の三角形番号から属するバッチの番号を求める.
+    UINT GetBatchFromTriangle(UINT triangle) const;
+
+    // 全バッチで共有するボーン行列パレット. 転置済みの行列を毎フレーム定数として書き込む.
+    static const UINT MaxBonePaletteCount = 1024;
+    std::vector<int>    bonePaletteNodes;  // パレットの各要素に対応するスケルトンのノード番号.
+    std::vector<Material> materials;
+    meshlet::MeshletData meshlets;  // ModelLoadFlag_BuildMeshlets 指定時のみ.
+
+    void Release();
+    // GPU が使用中かもしれない場合はこちら. バッファは queue に渡し, 完了後に解放される.
+    void Release(DeferredReleaseQueue& queue);
+
+    ModelMemoryStats GetMemoryStats() const;
+
+    // skeleton のワールド行列からボーン行列を計算して ring 上に書き込み, その GPU アドレスを返す.
+    // ボーンを持たないモデルでは 0 を返す.
+    D3D12_GPU_VIRTUAL_ADDRESS UpdateBonePalette(UploadRingBuffer& ring) const;
+    // パレット paletteIndex 番のボーン行列 (転置前).
+    DirectX::XMMATRIX GetBoneMatrix(size_t paletteIndex) const;
+
+    enum VBViewType {
+      VBV_Position = 0,
+      VBV_Normal,
+      VBV_UV0,
+      VBV_BlendIndices,
+      VBV_BlendWeights,
+      VBV_Tangent,
+    };
+    std::unordered_map<VBViewType, D3D12_VERTEX_BUFFER_VIEW> vertexBufferViews;
+    std::unordered_map<VBViewType, DXGI_FORMAT> vertexFormats;   // 入力レイアウト用のフォーマット.
+    bool isQuantized = false;
+    UINT indexBufferSize = 0;   // 16bit/32bit 混在のインデックスバッファの合計サイズ.
+
+    // 関連付けて保持しておきたい拡張バッファなど.
+    std::unordered_map<std::string, Buffer> extraBuffers;
+    std::unordered_map<std::string, DescriptorHandle> extraHandles;
+  };
+
+  enum ModelLoadFlag {
+    ModelLoadFlag_None = 0,
+    ModelLoadFlag_Flip_UV =     1u << 0,
+    ModelLoadFlag_CalcTangent=  1u << 1,  // 接線を生成する. キャッシュに無ければ読み込み後に生成する.
+    ModelLoadFlag_UseCache =    1u << 2,  // 変換済みバイナリキャッシュを読み書きする.
+    ModelLoadFlag_OptimizeMesh = 1u << 3, // 頂点キャッシュ/オーバードロー/頂点フェッチ向けに並び替える.
+    ModelLoadFlag_QuantizeVertex = 1u << 4, // 頂点ストリームを量子化フォーマットで生成する.
+    ModelLoadFlag_BuildMeshlets = 1u << 5,  // カリング用のメッシュレットを生成する.
+    ModelLoadFlag_GenerateLod = 1u << 6,    // 簡略化した LOD のインデックスを生成する.
+    ModelLoadFlag_CompressAnimation = 1u << 7, // アニメーションを圧縮形式で保持する.
+    ModelLoadFlag_KeepCpuData = 1u << 8,    // CPU 側の頂点/インデックスを ModelAsset::cpuData に残す.
+    ModelLoadFlag_DynamicBuffer = 1u << 9,  // 頂点/インデックスを UPLOAD ヒープに置き, CPU から書き換え可能にする.
+    ModelLoadFlag_BuildBvh = 1u << 10,      // レイキャスト/最近接点の問い合わせ用に ModelAsset::bvh を構築する.
+    ModelLoadFlag_WeldVertices = 1u << 11,  // 全ストリームが一致する重複頂点をまとめる.
+  };
+  inline ModelLoadFlag operator|(ModelLoadFlag a, ModelLoadFlag b) {
+    return ModelLoadFlag(uint32_t(a) | uint32_t(b));
+  }
+  ModelAsset LoadModelData(std::filesystem::path filePath, D3D12AppBase* appBase, ModelLoadFlag loadFlags = ModelLoadFlag_None);
+
+  // キャッシュの読み込み/インポートから最適化までの CPU 側の処理だけを行う. D3D12 には触れない.
+  ModelSourceData LoadModelSource(std::filesystem::path filePath, ModelLoadFlag loadFlags = ModelLoadFlag_None);
+
+  // CPU 側データから GPU リソースを生成する.
+  // commandList を渡すとコピーはそこへ積むだけで待たない. ステージングは appBase が保持する.
+  ModelAsset CreateModelAsset(const ModelSourceData& source, D3D12AppBase* appBase, ModelLoadFlag loadFlags = ModelLoadFlag_None,
+    ComPtr<ID3D12GraphicsCommandList> commandList = nullptr);
+
+  // 非同期読み込みの完了待ちハンドル.
+  // CPU 側の処理はワーカースレッドで進め, 完了後にメインスレッドで TryFinish を呼んで GPU リソースを作る.
+  class ModelLoadHandle {
+  public:
+    ModelLoadHandle(std::filesystem::path filePath, D3D12AppBase* appBase, ModelLoadFlag loadFlags);
+
+    // ワーカーの処理とマテリアルのテクスチャのデコードが終わっていれば true. 待たない.
+    bool IsReady() const;
+    bool IsFinished() const { return m_finished; }
+
+    // 準備ができていれば commandList にアップロードを積んで asset を設定し true を返す.
+    // 未完了なら何もせず false. ワーカーで発生した例外はここで再送出される.
+    bool TryFinish(D3D12AppBase* appBase, ComPtr<ID3D12GraphicsCommandList> commandList, ModelAsset& asset);
+
+    const std::filesystem::path& GetPath() const { return m_filePath; }
+  private:
+    std::filesystem::path m_filePath;
+    ModelLoadFlag m_loadFlags;
+    std::future<ModelSourceData> m_source;
+    bool m_finished = false;
+  };
+
+  // 読み込みをワーカースレッドで開始し, すぐに戻る. マテリアルのテクスチャのデコードもワーカーで予約する.
+  std::shared_ptr<ModelLoadHandle> LoadModelDataAsync(std::filesystem::path filePath, D3D12AppBase* appBase, ModelLoadFlag loadFlags = ModelLoadFlag_None);
+}
@@ -0,0 +1,84 @@
+#include "Skeleton.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace DirectX;
+
+namespace model {
+  int Skeleton::AddNode(const std::string& name, int parent,
+    const XMFLOAT4X4& localTransform, const XMFLOAT4X4& offsetMatrix) {
+    int index = int(m_parents.size());
+    m_parents.push_back(parent);
+    m_localTransforms.push_back(XMLoadFloat4x4(&localTransform));
+    m_worldTransforms.push_back(XMMatrixIdentity());
+    m_offsetMatrices.push_back(XMLoadFloat4x4(&offsetMatrix));
+    m_dirty.push_back(1);
+    m_names.push_back(name);
+    // 同名ノードは先に見つかった方を優先する.
+    m_nameToIndex.emplace(name, index);
+    return index;
+  }
+
+  void Skeleton::Clear() {
+    m_parents.clear();
+    m_localTransforms.clear();
+    m_worldTransforms.clear();
+    m_offsetMatrices.clear();
+    m_dirty.clear();
+    m_names.clear();
+    m_nameToIndex.clear();
+    m_hasRootTransform = false;
+  }
+
+  size_t Skeleton::GetMemorySize() const {
+    size_t size = sizeof(int) * m_parents.size() + m_dirty.size();
+    size += sizeof(XMMATRIX) * (m_localTransforms.size() + m_worldTransforms.size() + m_offsetMatrices.size());
+    for (const auto& name : m_names) {
+      size += sizeof(std::string) + name.capacity();
+    }
+    size += (sizeof(std::string) + sizeof(int)) * m_nameToIndex.size();
+    return size;
+  }
+
+  int Skeleton::FindNode(const std::string& name) const {
+    auto itr = m_nameToIndex.find(name);
+    if (itr == m_nameToIndex.end()) {
+      return InvalidNode;
+    }
+    return itr->second;
+  }
+
+  void Skeleton::SetLocalTransform(int node, FXMMATRIX transform) {
+    m_localTransforms[node] = transform;
+    m_dirty[node] = 1;
+  }
+
+  void Skeleton::UpdateWorldTransforms(FXMMATRIX mtxRoot) {
+    XMFLOAT4X4 root;
+    XMStoreFloat4x4(&root, mtxRoot);
+    bool rootChanged = !m_hasRootTransform || memcmp(&root, &m_rootTransform, sizeof(root)) != 0;
+    m_rootTransform = root;
+    m_hasRootTransform = true;
+
+    // 親が先に処理されるため, 親の更新フラグを子へ伝搬しながら 1 回で走査できる.
+    const auto count = m_parents.size();
+    for (size_t i = 0; i < count; ++i) {
+      int parent = m_parents[i];
+      if (parent == InvalidNode) {
+        if (m_dirty[i] || rootChanged) {
+          m_worldTransforms[i] = XMMatrixMultiply(m_localTransforms[i], mtxRoot);
+          m_dirty[i] = 1;
+        }
+        continue;
+      }
+      if (m_dirty[parent]) {
+        m_dirty[i] = 1;
+      }
+      if (m_dirty[i]) {
+        m_worldTransforms[i] = XMMatrixMultiply(m_localTransforms[i], m_worldTransforms[parent]);
+      }
+    }
+    std::fill(m_dirty.begin(), m_dirty.end(), uint8_t(0));
+  }
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <string>
+#include <unordered_map>
+#include <cstdint>
+
+namespace model {
+  // 親が必ず先に来る順序で並べた配列で表現するスケルトン.
+  // ワールド行列の更新は先頭からの 1 回のループで済み, 変更の無いノードは計算を省く.
+  class Skeleton {
+  public:
+    static const int InvalidNode = -1;
+
+    // parent は既に追加済みのノード番号 (ルートは InvalidNode).
+    int AddNode(const std::string& name, int parent,
+      const DirectX::XMFLOAT4X4& localTransform, const DirectX::XMFLOAT4X4& offsetMatrix);
+    void Clear();
+
+    int FindNode(const std::string& name) const;
+    int GetNodeCount() const { return int(m_parents.size()); }
+    int GetParent(int node) const { return m_parents[node]; }
+    const std::string& GetName(int node) const { return m_names[node]; }
+
+    DirectX::XMMATRIX GetLocalTransform(int node) const { return m_localTransforms[node]; }
+    DirectX::XMMATRIX GetWorldTransform(int node) const { return m_worldTransforms[node]; }
+    DirectX::XMMATRIX GetOffsetMatrix(int node) const { return m_offsetMatrices[node]; }
+    const DirectX::XMMATRIX* GetWorldTransforms() const { return m_worldTransforms.data(); }
+
+    // ローカル行列を変更し, 次の UpdateWorldTransforms で子孫も含めて再計算させる.
+    void SetLocalTransform(int node, DirectX::FXMMATRIX transform);
+
+    // mtxRoot はルートの親として掛ける行列.
+    void UpdateWorldTransforms(DirectX::FXMMATRIX mtxRoot);
+
+    // 保持している配列の合計バイト数 (概算).
+    size_t GetMemorySize() const;
+
+  private:
+    std::vector<int> m_parents;
+    std::vector<DirectX::XMMATRIX> m_localTransforms;
+    std::vector<DirectX::XMMATRIX> m_worldTransforms;
+    std::vector<DirectX::XMMATRIX> m_offsetMatrices;
+    std::vector<uint8_t> m_dirty;
+    std::vector<std::string> m_names;
+    std::unordered_map<std::string, int> m_nameToIndex;
+
+    DirectX::XMFLOAT4X4 m_rootTransform;
+    bool m_hasRootTransform = false;
+  };
+}
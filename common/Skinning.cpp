@@ -0,0 +1,87 @@
+#include "Skinning.h"
+#include "Model.h"
+
+#include <algorithm>
+#include <execution>
+#include <stdexcept>
+
+using namespace DirectX;
+
+namespace skinning {
+  void SkinVertices(
+    const SkinningInput& input, uint32_t first, uint32_t count,
+    const XMMATRIX* boneMatrices, const uint32_t* boneRemap,
+    XMFLOAT3* outPositions, XMFLOAT3* outNormals) {
+    for (uint32_t i = first; i < first + count; ++i) {
+      const auto& indices = input.boneIndices[i];
+      const auto weights = XMLoadFloat4(&input.boneWeights[i]);
+      const int32_t boneIndex[4] = { indices.x, indices.y, indices.z, indices.w };
+
+      // ウェイトで行列をブレンドしてから 1 回だけ変換する. 線形なのでシェーダーの結果と一致する.
+      XMVECTOR weight[4] = { XMVectorSplatX(weights), XMVectorSplatY(weights), XMVectorSplatZ(weights), XMVectorSplatW(weights) };
+      XMMATRIX mtx;
+      mtx.r[0] = mtx.r[1] = mtx.r[2] = mtx.r[3] = XMVectorZero();
+      for (int k = 0; k < 4; ++k) {
+        const auto& bone = boneMatrices[boneRemap[boneIndex[k]]];
+        mtx.r[0] = XMVectorMultiplyAdd(bone.r[0], weight[k], mtx.r[0]);
+        mtx.r[1] = XMVectorMultiplyAdd(bone.r[1], weight[k], mtx.r[1]);
+        mtx.r[2] = XMVectorMultiplyAdd(bone.r[2], weight[k], mtx.r[2]);
+        mtx.r[3] = XMVectorMultiplyAdd(bone.r[3], weight[k], mtx.r[3]);
+      }
+
+      auto position = XMVector3Transform(XMLoadFloat3(&input.positions[i]), mtx);
+      XMStoreFloat3(&outPositions[i], position);
+      if (input.normals && outNormals) {
+        auto normal = XMVector3TransformNormal(XMLoadFloat3(&input.normals[i]), mtx);
+        XMStoreFloat3(&outNormals[i], XMVector3Normalize(normal));
+      }
+    }
+  }
+
+  void SkinModel(
+    const model::ModelAsset& model,
+    std::vector<XMFLOAT3>& outPositions, std::vector<XMFLOAT3>& outNormals,
+    uint32_t verticesPerJob) {
+    const auto* source = model.cpuData.get();
+    if (source == nullptr) {
+      throw std::runtime_error("SkinModel requires ModelLoadFlag_KeepCpuData.");
+    }
+    outPositions.resize(source->position.size());
+    outNormals.resize(source->normal.size());
+    if (source->boneIndices.empty()) {
+      std::copy(source->position.begin(), source->position.end(), outPositions.begin());
+      std::copy(source->normal.begin(), source->normal.end(), outNormals.begin());
+      return;
+    }
+
+    std::vector<XMMATRIX> boneMatrices(model.bonePaletteNodes.size());
+    for (size_t i = 0; i < boneMatrices.size(); ++i) {
+      boneMatrices[i] = model.GetBoneMatrix(i);
+    }
+
+    // バッチの頂点範囲を一定数ずつに分けて並列に処理する.
+    struct Job {
+      uint32_t batch;
+      uint32_t first, count;
+    };
+    std::vector<Job> jobs;
+    verticesPerJob = std::max(verticesPerJob, 1u);
+    for (uint32_t b = 0; b < uint32_t(model.DrawBatches.size()); ++b) {
+      const auto& batch = model.DrawBatches[b];
+      for (uint32_t offset = 0; offset < batch.vertexCount; offset += verticesPerJob) {
+        jobs.push_back({ b, batch.vertexOffsetCount + offset, std::min(verticesPerJob, batch.vertexCount - offset) });
+      }
+    }
+
+    SkinningInput input;
+    input.positions = source->position.data();
+    input.normals = source->normal.empty() ? nullptr : source->normal.data();
+    input.boneIndices = source->boneIndices.data();
+    input.boneWeights = source->boneWeights.data();
+    std::for_each(std::execution::par, jobs.begin(), jobs.end(), [&](const Job& job) {
+      const auto& remap = model.DrawBatches[job.batch].boneRemap;
+      SkinVertices(input, job.first, job.count, boneMatrices.data(), remap.data(),
+        outPositions.data(), input.normals ? outNormals.data() : nullptr);
+    });
+  }
+}
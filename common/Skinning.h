@@ -0,0 +1,33 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+
+namespace model {
+  struct ModelAsset;
+}
+
+// CPU によるスキニング. StreamOutput/shaderSOFromVS.hlsl の TransformPosition/TransformNormal と同じ計算を行う.
+namespace skinning {
+  struct SkinningInput {
+    const DirectX::XMFLOAT3* positions = nullptr;
+    const DirectX::XMFLOAT3* normals = nullptr;      // 省略可.
+    const DirectX::XMINT4*   boneIndices = nullptr;
+    const DirectX::XMFLOAT4* boneWeights = nullptr;
+  };
+
+  // [first, first+count) の頂点を変形する. ボーン番号は boneRemap でパレット番号へ変換する.
+  // boneMatrices は行ベクトル形式 (転置前) の行列.
+  void SkinVertices(
+    const SkinningInput& input, uint32_t first, uint32_t count,
+    const DirectX::XMMATRIX* boneMatrices, const uint32_t* boneRemap,
+    DirectX::XMFLOAT3* outPositions, DirectX::XMFLOAT3* outNormals);
+
+  // モデル全体を verticesPerJob 頂点ずつに分けて並列に変形する.
+  // ModelLoadFlag_KeepCpuData で読み込んだモデルが必要. 現在の skeleton の姿勢を使う.
+  void SkinModel(
+    const model::ModelAsset& model,
+    std::vector<DirectX::XMFLOAT3>& outPositions, std::vector<DirectX::XMFLOAT3>& outNormals,
+    uint32_t verticesPerJob = 4096);
+}
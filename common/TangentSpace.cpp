@@ -0,0 +1,85 @@
+#include "TangentSpace.h"
+
+#include <vector>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace {
+  // v を normal に直交する成分だけにして正規化する. 長さが無ければ 0 を返す.
+  XMVECTOR ProjectToPlane(FXMVECTOR v, FXMVECTOR normal) {
+    auto projected = v - normal * XMVector3Dot(normal, v);
+    auto lengthSq = XMVectorGetX(XMVector3LengthSq(projected));
+    if (lengthSq < 1.0e-20f) {
+      return XMVectorZero();
+    }
+    return projected / std::sqrt(lengthSq);
+  }
+
+  // normal に直交する適当な単位ベクトル.
+  XMVECTOR MakePerpendicular(FXMVECTOR normal) {
+    auto axis = std::abs(XMVectorGetX(normal)) < 0.9f ? XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f) : XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f);
+    return XMVector3Normalize(XMVector3Cross(axis, normal));
+  }
+
+  // 2 辺のなす角.
+  float CornerAngle(FXMVECTOR e0, FXMVECTOR e1) {
+    auto len = std::sqrt(XMVectorGetX(XMVector3LengthSq(e0)) * XMVectorGetX(XMVector3LengthSq(e1)));
+    if (len <= 0.0f) {
+      return 0.0f;
+    }
+    auto c = XMVectorGetX(XMVector3Dot(e0, e1)) / len;
+    return std::acos(c < -1.0f ? -1.0f : (c > 1.0f ? 1.0f : c));
+  }
+}
+
+namespace tangent_space {
+  void GenerateTangents(
+    const uint32_t* indices, size_t indexCount,
+    const XMFLOAT3* positions, const XMFLOAT3* normals, const XMFLOAT2* uvs,
+    uint32_t vertexCount, XMFLOAT4* tangents) {
+    std::vector<XMVECTOR> tangentSum(vertexCount, XMVectorZero());
+    std::vector<XMVECTOR> binormalSum(vertexCount, XMVectorZero());
+
+    for (size_t i = 0; i + 2 < indexCount; i += 3) {
+      const uint32_t tri[3] = { indices[i], indices[i + 1], indices[i + 2] };
+      XMVECTOR p[3];
+      XMFLOAT2 uv[3];
+      for (int k = 0; k < 3; ++k) {
+        p[k] = XMLoadFloat3(&positions[tri[k]]);
+        uv[k] = uvs[tri[k]];
+      }
+
+      auto e1 = p[1] - p[0];
+      auto e2 = p[2] - p[0];
+      float du1 = uv[1].x - uv[0].x, dv1 = uv[1].y - uv[0].y;
+      float du2 = uv[2].x - uv[0].x, dv2 = uv[2].y - uv[0].y;
+      float det = du1 * dv2 - du2 * dv1;
+      if (std::abs(det) < 1.0e-20f) {
+        continue;
+      }
+      // UV の u/v 方向に対応する面の接線と従法線. 大きさは向きの判定にしか使わない.
+      auto faceTangent = (e1 * dv2 - e2 * dv1) / det;
+      auto faceBinormal = (e2 * du1 - e1 * du2) / det;
+
+      for (int k = 0; k < 3; ++k) {
+        auto v = tri[k];
+        auto normal = XMLoadFloat3(&normals[v]);
+        auto angle = CornerAngle(p[(k + 1) % 3] - p[k], p[(k + 2) % 3] - p[k]);
+        tangentSum[v] += ProjectToPlane(faceTangent, normal) * angle;
+        binormalSum[v] += ProjectToPlane(faceBinormal, normal) * angle;
+      }
+    }
+
+    for (uint32_t v = 0; v < vertexCount; ++v) {
+      auto normal = XMLoadFloat3(&normals[v]);
+      auto tangent = ProjectToPlane(tangentSum[v], normal);
+      if (XMVectorGetX(XMVector3LengthSq(tangent)) == 0.0f) {
+        tangent = MakePerpendicular(normal);
+      }
+      // 合成した従法線が cross(normal, tangent) と逆向きなら鏡像の UV.
+      float w = XMVectorGetX(XMVector3Dot(XMVector3Cross(normal, tangent), binormalSum[v])) < 0.0f ? -1.0f : 1.0f;
+      XMStoreFloat4(&tangents[v], XMVectorSetW(tangent, w));
+    }
+  }
+}
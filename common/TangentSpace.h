@@ -0,0 +1,16 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <cstdint>
+
+// 法線マップ用の接線の生成. MikkTSpace と同じく, 面ごとの接線を頂点法線の接平面へ射影し,
+// 頂点での角度で重み付けして合成する.
+namespace tangent_space {
+  // 1 メッシュ分の接線を計算する. indices はメッシュローカルの頂点番号で 3 つで 1 三角形.
+  // tangents[i].xyz は法線に直交する単位ベクトル, w は従法線の向き (binormal = cross(normal, tangent) * w).
+  // UV が縮退した頂点には法線に直交する任意の向きを設定する.
+  void GenerateTangents(
+    const uint32_t* indices, size_t indexCount,
+    const DirectX::XMFLOAT3* positions, const DirectX::XMFLOAT3* normals, const DirectX::XMFLOAT2* uvs,
+    uint32_t vertexCount, DirectX::XMFLOAT4* tangents);
+}
@@ -0,0 +1,130 @@
+#include "TextureDecoder.h"
+
+#include <filesystem>
+#include <stdexcept>
+#include <algorithm>
+#include <objbase.h>
+
+using namespace DirectX;
+namespace fs = std::filesystem;
+
+TextureDecoder::TextureDecoder(uint32_t threadCount) : m_stop(false)
+{
+  if (threadCount == 0) {
+    threadCount = (std::max)(std::thread::hardware_concurrency(), 2u) - 1;
+  }
+  for (uint32_t i = 0; i < threadCount; ++i) {
+    m_threads.emplace_back([this]() { WorkerMain(); });
+  }
+}
+
+TextureDecoder::~TextureDecoder()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stop = true;
+  }
+  m_condition.notify_all();
+  for (auto& t : m_threads) {
+    t.join();
+  }
+}
+
+std::shared_future<TextureDecoder::ImagePtr> TextureDecoder::Request(const std::string& filename, bool generateMips)
+{
+  auto key = GetRequestKey(filename, generateMips);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  auto it = m_pending.find(key);
+  if (it != m_pending.end()) {
+    return it->second;
+  }
+  std::packaged_task<ImagePtr()> job([filename, generateMips]() { return Decode(filename, generateMips); });
+  auto result = job.get_future().share();
+  m_pending.emplace(key, result);
+  m_jobs.push_back({ key, std::move(job) });
+  m_condition.notify_one();
+  return result;
+}
+
+TextureDecoder::ImagePtr TextureDecoder::Take(const std::string& filename, bool generateMips)
+{
+  auto result = Request(filename, generateMips);
+  {
+    // ジョブは残したまま予約だけを外す.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending.erase(GetRequestKey(filename, generateMips));
+  }
+  return result.get();
+}
+
+void TextureDecoder::Cancel(const std::string& filename, bool generateMips)
+{
+  auto key = GetRequestKey(filename, generateMips);
+  std::lock_guard<std::mutex> lock(m_mutex);
+  m_pending.erase(key);
+  // 待ち行列に残っていれば取り除く. 待っている側には broken_promise が返る.
+  auto it = std::find_if(m_jobs.begin(), m_jobs.end(), [&key](const Job& job) { return job.key == key; });
+  if (it != m_jobs.end()) {
+    m_jobs.erase(it);
+  }
+}
+
+std::string TextureDecoder::GetRequestKey(const std::string& filename, bool generateMips)
+{
+  return generateMips ? filename + "|mips" : filename;
+}
+
+TextureDecoder::ImagePtr TextureDecoder::Decode(const std::string& filename, bool generateMips)
+{
+  fs::path loadPath(filename);
+  auto extension = loadPath.extension().string();
+
+  auto result = std::make_shared<Image>();
+  HRESULT hr = E_FAIL;
+  if (extension == ".tga") {
+    hr = DirectX::LoadFromTGAFile(loadPath.c_str(), &result->metadata, result->image);
+  }
+  if (extension == ".jpg" || extension == ".png") {
+    WIC_FLAGS flags = WIC_FLAGS_NONE;
+    hr = DirectX::LoadFromWICFile(loadPath.c_str(), flags, &result->metadata, result->image);
+  }
+  if (extension == ".dds") {
+    DDS_FLAGS flags = DDS_FLAGS_NONE;
+    hr = DirectX::LoadFromDDSFile(loadPath.c_str(), flags, &result->metadata, result->image);
+  }
+  if (FAILED(hr)) {
+    throw std::runtime_error("Texture file not found.");
+  }
+
+  const auto& metadata = result->metadata;
+  if (generateMips && metadata.mipLevels == 1 && !IsCompressed(metadata.format) &&
+    (metadata.width > 1 || metadata.height > 1)) {
+    ScratchImage mipChain;
+    hr = GenerateMipMaps(result->image.GetImages(), result->image.GetImageCount(), metadata, TEX_FILTER_DEFAULT, 0, mipChain);
+    if (SUCCEEDED(hr)) {
+      result->metadata = mipChain.GetMetadata();
+      result->image = std::move(mipChain);
+    }
+  }
+  return result;
+}
+
+void TextureDecoder::WorkerMain()
+{
+  // WIC を使うためスレッドごとに COM を初期化する.
+  CoInitializeEx(nullptr, COINIT_MULTITHREADED);
+  for (;;) {
+    Job job;
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_condition.wait(lock, [this]() { return m_stop || !m_jobs.empty(); });
+      if (m_stop) {
+        break;
+      }
+      job = std::move(m_jobs.front());
+      m_jobs.pop_front();
+    }
+    job.task();
+  }
+  CoUninitialize();
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include <DirectXTex.h>
+#include <string>
+#include <memory>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <vector>
+#include <unordered_map>
+
+// テクスチャファイルの読み込みとデコードを行うワーカースレッドのプール.
+// GPU リソースの作成とアップロードの記録は呼び出し側 (D3D12AppBase::LoadTexture) のスレッドで行う.
+class TextureDecoder
+{
+public:
+  struct Image {
+    DirectX::TexMetadata metadata{};
+    DirectX::ScratchImage image;
+  };
+  using ImagePtr = std::shared_ptr<const Image>;
+
+  // threadCount が 0 ならハードウェアスレッド数 - 1 (最低 1).
+  explicit TextureDecoder(uint32_t threadCount = 0);
+  ~TextureDecoder();
+
+  // デコードを予約する. 同じファイルへの予約は 1 つにまとめる. どのスレッドから呼んでもよい.
+  // generateMips を指定するとミップマップの無い非圧縮テクスチャにミップを生成する.
+  std::shared_future<ImagePtr> Request(const std::string& filename, bool generateMips = false);
+
+  // 予約済み (無ければここで予約) の結果を待って受け取り, 予約を取り除く.
+  // 読み込みに失敗した場合は std::runtime_error を送出する.
+  ImagePtr Take(const std::string& filename, bool generateMips = false);
+
+  // 不要になった予約を取り除く. まだ始まっていなければデコードもしない. デコード中なら結果は捨てられる.
+  void Cancel(const std::string& filename, bool generateMips = false);
+
+  // 予約を区別するキー. ミップ生成の有無が異なれば別の予約になる.
+  static std::string GetRequestKey(const std::string& filename, bool generateMips);
+
+  // 呼び出したスレッドでデコードする.
+  static ImagePtr Decode(const std::string& filename, bool generateMips);
+
+private:
+  void WorkerMain();
+
+  struct Job {
+    std::string key;
+    std::packaged_task<ImagePtr()> task;
+  };
+
+  std::vector<std::thread> m_threads;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::deque<Job> m_jobs;
+  std::unordered_map<std::string, std::shared_future<ImagePtr>> m_pending;
+  bool m_stop;
+};
@@ -0,0 +1,417 @@
+#include "TriangleBvh.h"
+
+#include <algorithm>
+#include <execution>
+#include <numeric>
+#include <cmath>
+#include <cfloat>
+
+using namespace DirectX;
+
+namespace {
+  const uint32_t BinCount = 12;
+  // これ以下の三角形数のサブツリーは並列構築のタスクとして切り出す.
+  const uint32_t ParallelSubtreeTriangles = 4096;
+  // 走査スタックが溢れないよう木の深さを制限する.
+  const uint32_t MaxTreeDepth = 60;
+  const int MaxStackDepth = MaxTreeDepth + 2;
+
+  struct Aabb {
+    XMVECTOR boundsMin = XMVectorReplicate(FLT_MAX);
+    XMVECTOR boundsMax = XMVectorReplicate(-FLT_MAX);
+
+    void Grow(FXMVECTOR p) {
+      boundsMin = XMVectorMin(boundsMin, p);
+      boundsMax = XMVectorMax(boundsMax, p);
+    }
+    void Grow(const Aabb& other) {
+      boundsMin = XMVectorMin(boundsMin, other.boundsMin);
+      boundsMax = XMVectorMax(boundsMax, other.boundsMax);
+    }
+    float GetArea() const {
+      auto e = XMVectorMax(boundsMax - boundsMin, XMVectorZero());
+      auto x = XMVectorGetX(e), y = XMVectorGetY(e), z = XMVectorGetZ(e);
+      return x * y + y * z + z * x;
+    }
+  };
+
+  struct BuildContext {
+    std::vector<Aabb> triangleBounds;
+    std::vector<XMFLOAT3> centroids;
+    std::vector<uint32_t> order;  // 葉の並び順になるよう並び替える三角形番号.
+    uint32_t maxLeafTriangles;
+  };
+
+  struct BuildTask {
+    uint32_t nodeIndex;
+    uint32_t first;
+    uint32_t count;
+    uint32_t depth;
+  };
+
+  float GetComponent(const XMFLOAT3& v, int axis) {
+    return axis == 0 ? v.x : (axis == 1 ? v.y : v.z);
+  }
+
+  // nodes[nodeIndex] 以下を構築する. tasks が指定された場合は小さなサブツリーを構築せずに積む.
+  void BuildNode(BuildContext& ctx, std::vector<bvh::Node>& nodes, uint32_t nodeIndex,
+    uint32_t first, uint32_t count, uint32_t depth, std::vector<BuildTask>* tasks) {
+    Aabb bounds, centroidBounds;
+    for (uint32_t i = first; i < first + count; ++i) {
+      auto tri = ctx.order[i];
+      bounds.Grow(ctx.triangleBounds[tri]);
+      centroidBounds.Grow(XMLoadFloat3(&ctx.centroids[tri]));
+    }
+    auto& node = nodes[nodeIndex];
+    XMStoreFloat3(&node.boundsMin, bounds.boundsMin);
+    XMStoreFloat3(&node.boundsMax, bounds.boundsMax);
+    node.leftOrFirst = first;
+    node.count = count;
+    if (count <= 1 || depth >= MaxTreeDepth) {
+      return;
+    }
+    if (tasks && count <= ParallelSubtreeTriangles) {
+      tasks->push_back({ nodeIndex, first, count, depth });
+      return;
+    }
+
+    // 軸ごとに重心をビンへ振り分け, SAH コストが最小となる分割を探す.
+    XMFLOAT3 cMin, cMax;
+    XMStoreFloat3(&cMin, centroidBounds.boundsMin);
+    XMStoreFloat3(&cMax, centroidBounds.boundsMax);
+    int bestAxis = -1;
+    uint32_t bestSplit = 0;
+    float bestCost = FLT_MAX;
+    for (int axis = 0; axis < 3; ++axis) {
+      float minValue = GetComponent(cMin, axis);
+      float extent = GetComponent(cMax, axis) - minValue;
+      if (extent <= 0.0f) {
+        continue;
+      }
+      Aabb binBounds[BinCount];
+      uint32_t binCounts[BinCount] = {};
+      float scale = BinCount / extent;
+      for (uint32_t i = first; i < first + count; ++i) {
+        auto tri = ctx.order[i];
+        auto bin = std::min(BinCount - 1, uint32_t((GetComponent(ctx.centroids[tri], axis) - minValue) * scale));
+        binBounds[bin].Grow(ctx.triangleBounds[tri]);
+        binCounts[bin]++;
+      }
+
+      // 右側からの累積を先に求め, 左側を伸ばしながら評価する.
+      float rightArea[BinCount];
+      uint32_t rightCount[BinCount];
+      Aabb right;
+      uint32_t rightSum = 0;
+      for (uint32_t b = BinCount - 1; b > 0; --b) {
+        right.Grow(binBounds[b]);
+        rightSum += binCounts[b];
+        rightArea[b] = right.GetArea();
+        rightCount[b] = rightSum;
+      }
+      Aabb left;
+      uint32_t leftSum = 0;
+      for (uint32_t b = 0; b < BinCount - 1; ++b) {
+        left.Grow(binBounds[b]);
+        leftSum += binCounts[b];
+        if (leftSum == 0 || rightCount[b + 1] == 0) {
+          continue;
+        }
+        float cost = left.GetArea() * leftSum + rightArea[b + 1] * rightCount[b + 1];
+        if (cost < bestCost) {
+          bestCost = cost;
+          bestAxis = axis;
+          bestSplit = b;
+        }
+      }
+    }
+
+    // 走査コストを 1, 三角形 1 つの交差判定コストを 1 として葉にするかを決める.
+    float parentArea = bounds.GetArea();
+    float splitCost = 1.0f + (parentArea > 0.0f ? bestCost / parentArea : float(count));
+    if (bestAxis < 0 || (count <= ctx.maxLeafTriangles && splitCost >= float(count))) {
+      return;
+    }
+
+    float minValue = GetComponent(cMin, bestAxis);
+    float scale = BinCount / (GetComponent(cMax, bestAxis) - minValue);
+    auto begin = ctx.order.begin() + first;
+    auto middle = std::partition(begin, begin + count, [&](uint32_t tri) {
+      auto bin = std::min(BinCount - 1, uint32_t((GetComponent(ctx.centroids[tri], bestAxis) - minValue) * scale));
+      return bin <= bestSplit;
+    });
+    auto leftCount = uint32_t(middle - begin);
+    if (leftCount == 0 || leftCount == count) {
+      leftCount = count / 2;
+    }
+
+    auto leftIndex = uint32_t(nodes.size());
+    nodes[nodeIndex].leftOrFirst = leftIndex;
+    nodes[nodeIndex].count = 0;
+    nodes.resize(nodes.size() + 2);
+    BuildNode(ctx, nodes, leftIndex, first, leftCount, depth + 1, tasks);
+    BuildNode(ctx, nodes, leftIndex + 1, first + leftCount, count - leftCount, depth + 1, tasks);
+  }
+
+  // レイとノードの AABB のスラブ判定. 3 軸をまとめて計算する.
+  bool IntersectBounds(const bvh::Node& node, FXMVECTOR origin, FXMVECTOR invDir, float maxDistance, float& enter) {
+    auto t0 = (XMLoadFloat3(&node.boundsMin) - origin) * invDir;
+    auto t1 = (XMLoadFloat3(&node.boundsMax) - origin) * invDir;
+    XMFLOAT3 tNear, tFar;
+    XMStoreFloat3(&tNear, XMVectorMin(t0, t1));
+    XMStoreFloat3(&tFar, XMVectorMax(t0, t1));
+    enter = std::max(std::max(tNear.x, tNear.y), std::max(tNear.z, 0.0f));
+    float exit = std::min(std::min(tFar.x, tFar.y), std::min(tFar.z, maxDistance));
+    return enter <= exit;
+  }
+
+  float GetBoundsDistanceSq(const bvh::Node& node, FXMVECTOR point) {
+    auto d = XMVectorMax(XMLoadFloat3(&node.boundsMin) - point, point - XMLoadFloat3(&node.boundsMax));
+    d = XMVectorMax(d, XMVectorZero());
+    return XMVectorGetX(XMVector3LengthSq(d));
+  }
+
+  // Real-Time Collision Detection 5.1.5 の方法で三角形上の最近接点を求める.
+  XMVECTOR ClosestPointOnTriangle(FXMVECTOR p, FXMVECTOR a, FXMVECTOR b, GXMVECTOR c) {
+    auto ab = b - a, ac = c - a, ap = p - a;
+    float d1 = XMVectorGetX(XMVector3Dot(ab, ap));
+    float d2 = XMVectorGetX(XMVector3Dot(ac, ap));
+    if (d1 <= 0.0f && d2 <= 0.0f) {
+      return a;
+    }
+    auto bp = p - b;
+    float d3 = XMVectorGetX(XMVector3Dot(ab, bp));
+    float d4 = XMVectorGetX(XMVector3Dot(ac, bp));
+    if (d3 >= 0.0f && d4 <= d3) {
+      return b;
+    }
+    float vc = d1 * d4 - d3 * d2;
+    if (vc <= 0.0f && d1 >= 0.0f && d3 <= 0.0f) {
+      return a + ab * (d1 / (d1 - d3));
+    }
+    auto cp = p - c;
+    float d5 = XMVectorGetX(XMVector3Dot(ab, cp));
+    float d6 = XMVectorGetX(XMVector3Dot(ac, cp));
+    if (d6 >= 0.0f && d5 <= d6) {
+      return c;
+    }
+    float vb = d5 * d2 - d1 * d6;
+    if (vb <= 0.0f && d2 >= 0.0f && d6 <= 0.0f) {
+      return a + ac * (d2 / (d2 - d6));
+    }
+    float va = d3 * d6 - d5 * d4;
+    if (va <= 0.0f && (d4 - d3) >= 0.0f && (d5 - d6) >= 0.0f) {
+      return b + (c - b) * ((d4 - d3) / ((d4 - d3) + (d5 - d6)));
+    }
+    float denom = 1.0f / (va + vb + vc);
+    return a + ab * (vb * denom) + ac * (vc * denom);
+  }
+}
+
+namespace bvh {
+  void TriangleBvh::Clear() {
+    m_nodes.clear();
+    m_triangles.clear();
+    m_triangleIds.clear();
+  }
+
+  void TriangleBvh::Build(const XMFLOAT3* positions, const uint32_t* indices, size_t indexCount, uint32_t maxLeafTriangles) {
+    Clear();
+    auto triangleCount = uint32_t(indexCount / 3);
+    if (triangleCount == 0) {
+      return;
+    }
+
+    BuildContext ctx;
+    ctx.maxLeafTriangles = std::max(maxLeafTriangles, 1u);
+    ctx.triangleBounds.resize(triangleCount);
+    ctx.centroids.resize(triangleCount);
+    ctx.order.resize(triangleCount);
+    std::iota(ctx.order.begin(), ctx.order.end(), 0u);
+    std::for_each(std::execution::par, ctx.order.begin(), ctx.order.end(), [&](uint32_t tri) {
+      Aabb box;
+      for (int k = 0; k < 3; ++k) {
+        box.Grow(XMLoadFloat3(&positions[indices[tri * 3 + k]]));
+      }
+      ctx.triangleBounds[tri] = box;
+      XMStoreFloat3(&ctx.centroids[tri], (box.boundsMin + box.boundsMax) * 0.5f);
+    });
+
+    // 上位の階層を逐次に作り, 残りのサブツリーを並列に構築してから繋ぎ合わせる.
+    // 各サブツリーは order の重ならない範囲だけを並び替える.
+    std::vector<BuildTask> tasks;
+    m_nodes.resize(1);
+    BuildNode(ctx, m_nodes, 0, 0, triangleCount, 0, &tasks);
+
+    std::vector<std::vector<Node>> subtrees(tasks.size());
+    std::vector<size_t> taskIndices(tasks.size());
+    std::iota(taskIndices.begin(), taskIndices.end(), size_t(0));
+    std::for_each(std::execution::par, taskIndices.begin(), taskIndices.end(), [&](size_t i) {
+      auto& local = subtrees[i];
+      local.reserve(tasks[i].count * 2 / ctx.maxLeafTriangles + 1);
+      local.resize(1);
+      BuildNode(ctx, local, 0, tasks[i].first, tasks[i].count, tasks[i].depth, nullptr);
+    });
+
+    for (size_t i = 0; i < tasks.size(); ++i) {
+      const auto& local = subtrees[i];
+      // ローカルの番号 l (>= 1) は base + l へ移る.
+      auto base = uint32_t(m_nodes.size()) - 1;
+      auto relocate = [base](Node n) {
+        if (!n.IsLeaf()) {
+          n.leftOrFirst += base;
+        }
+        return n;
+      };
+      m_nodes[tasks[i].nodeIndex] = relocate(local[0]);
+      for (size_t l = 1; l < local.size(); ++l) {
+        m_nodes.push_back(relocate(local[l]));
+      }
+    }
+
+    m_triangles.resize(triangleCount);
+    m_triangleIds = std::move(ctx.order);
+    for (uint32_t i = 0; i < triangleCount; ++i) {
+      auto tri = m_triangleIds[i];
+      m_triangles[i] = { positions[indices[tri * 3 + 0]], positions[indices[tri * 3 + 1]], positions[indices[tri * 3 + 2]] };
+    }
+  }
+
+  bool TriangleBvh::RayCast(FXMVECTOR origin, FXMVECTOR direction, float maxDistance, RayHit& hit) const {
+    if (m_nodes.empty()) {
+      return false;
+    }
+    auto dir = XMVector3Normalize(direction);
+    auto invDir = XMVectorReciprocal(dir);
+    float bestDistance = maxDistance;
+    bool found = false;
+
+    struct Entry {
+      uint32_t node;
+      float enter;
+    };
+    Entry stack[MaxStackDepth];
+    int sp = 0;
+    float enter;
+    if (IntersectBounds(m_nodes[0], origin, invDir, bestDistance, enter)) {
+      stack[sp++] = { 0, enter };
+    }
+    while (sp > 0) {
+      auto entry = stack[--sp];
+      if (entry.enter > bestDistance) {
+        continue;
+      }
+      const auto& node = m_nodes[entry.node];
+      if (node.IsLeaf()) {
+        // Moller-Trumbore 法.
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+          const auto& tri = m_triangles[i];
+          auto v0 = XMLoadFloat3(&tri.v0);
+          auto e1 = XMLoadFloat3(&tri.v1) - v0;
+          auto e2 = XMLoadFloat3(&tri.v2) - v0;
+          auto p = XMVector3Cross(dir, e2);
+          float det = XMVectorGetX(XMVector3Dot(e1, p));
+          if (std::fabs(det) < 1.0e-12f) {
+            continue;
+          }
+          float invDet = 1.0f / det;
+          auto s = origin - v0;
+          float u = XMVectorGetX(XMVector3Dot(s, p)) * invDet;
+          if (u < 0.0f || u > 1.0f) {
+            continue;
+          }
+          auto q = XMVector3Cross(s, e1);
+          float v = XMVectorGetX(XMVector3Dot(dir, q)) * invDet;
+          if (v < 0.0f || u + v > 1.0f) {
+            continue;
+          }
+          float t = XMVectorGetX(XMVector3Dot(e2, q)) * invDet;
+          if (t < 0.0f || t >= bestDistance) {
+            continue;
+          }
+          bestDistance = t;
+          hit = { t, m_triangleIds[i], u, v };
+          found = true;
+        }
+        continue;
+      }
+
+      // 近い子から先に調べるよう, 遠い方を先に積む.
+      float enterL, enterR;
+      bool hitL = IntersectBounds(m_nodes[node.leftOrFirst], origin, invDir, bestDistance, enterL);
+      bool hitR = IntersectBounds(m_nodes[node.leftOrFirst + 1], origin, invDir, bestDistance, enterR);
+      if (hitL && hitR) {
+        if (enterL <= enterR) {
+          stack[sp++] = { node.leftOrFirst + 1, enterR };
+          stack[sp++] = { node.leftOrFirst, enterL };
+        } else {
+          stack[sp++] = { node.leftOrFirst, enterL };
+          stack[sp++] = { node.leftOrFirst + 1, enterR };
+        }
+      } else if (hitL) {
+        stack[sp++] = { node.leftOrFirst, enterL };
+      } else if (hitR) {
+        stack[sp++] = { node.leftOrFirst + 1, enterR };
+      }
+    }
+    return found;
+  }
+
+  bool TriangleBvh::FindClosestPoint(FXMVECTOR point, float maxDistance, ClosestPointResult& result) const {
+    if (m_nodes.empty()) {
+      return false;
+    }
+    float bestDistanceSq = maxDistance * maxDistance;
+    bool found = false;
+
+    struct Entry {
+      uint32_t node;
+      float distanceSq;
+    };
+    Entry stack[MaxStackDepth];
+    int sp = 0;
+    stack[sp++] = { 0, GetBoundsDistanceSq(m_nodes[0], point) };
+    while (sp > 0) {
+      auto entry = stack[--sp];
+      if (entry.distanceSq > bestDistanceSq) {
+        continue;
+      }
+      const auto& node = m_nodes[entry.node];
+      if (node.IsLeaf()) {
+        for (uint32_t i = node.leftOrFirst; i < node.leftOrFirst + node.count; ++i) {
+          const auto& tri = m_triangles[i];
+          auto cp = ClosestPointOnTriangle(point, XMLoadFloat3(&tri.v0), XMLoadFloat3(&tri.v1), XMLoadFloat3(&tri.v2));
+          float d = XMVectorGetX(XMVector3LengthSq(cp - point));
+          if (d <= bestDistanceSq) {
+            bestDistanceSq = d;
+            XMStoreFloat3(&result.position, cp);
+            result.triangle = m_triangleIds[i];
+            found = true;
+          }
+        }
+        continue;
+      }
+
+      float dL = GetBoundsDistanceSq(m_nodes[node.leftOrFirst], point);
+      float dR = GetBoundsDistanceSq(m_nodes[node.leftOrFirst + 1], point);
+      Entry nearEntry = { node.leftOrFirst, dL }, farEntry = { node.leftOrFirst + 1, dR };
+      if (dR < dL) {
+        std::swap(nearEntry, farEntry);
+      }
+      if (farEntry.distanceSq <= bestDistanceSq) {
+        stack[sp++] = farEntry;
+      }
+      if (nearEntry.distanceSq <= bestDistanceSq) {
+        stack[sp++] = nearEntry;
+      }
+    }
+    if (found) {
+      result.distance = std::sqrt(bestDistanceSq);
+    }
+    return found;
+  }
+
+  size_t TriangleBvh::GetMemorySize() const {
+    return sizeof(Node) * m_nodes.size() + sizeof(Triangle) * m_triangles.size() + sizeof(uint32_t) * m_triangleIds.size();
+  }
+}
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <DirectXMath.h>
+#include <vector>
+#include <cstdint>
+
+// 三角形を格納する BVH. SAH (Surface Area Heuristic) で分割し, レイキャストと最近接点の問い合わせに使う.
+namespace bvh {
+  // 32 バイトのノード. count == 0 なら内部ノードで, 子は leftOrFirst と leftOrFirst + 1.
+  // 葉では leftOrFirst から count 個の三角形を持つ.
+  struct Node {
+    DirectX::XMFLOAT3 boundsMin;
+    uint32_t leftOrFirst;
+    DirectX::XMFLOAT3 boundsMax;
+    uint32_t count;
+
+    bool IsLeaf() const { return count > 0; }
+  };
+  static_assert(sizeof(Node) == 32, "bvh::Node must be 32 bytes.");
+
+  struct RayHit {
+    float distance;     // 正規化したレイ方向での距離.
+    uint32_t triangle;  // Build に渡した三角形の番号.
+    float u, v;         // 重心座標 (position = v0 * (1 - u - v) + v1 * u + v2 * v).
+  };
+
+  struct ClosestPointResult {
+    DirectX::XMFLOAT3 position;
+    float distance;
+    uint32_t triangle;
+  };
+
+  class TriangleBvh {
+  public:
+    static const uint32_t DefaultMaxLeafTriangles = 4;
+
+    // indices は 3 つで 1 三角形. 三角形の番号は indices 上の並び順.
+    // 大きなサブツリーは並列に構築する.
+    void Build(const DirectX::XMFLOAT3* positions, const uint32_t* indices, size_t indexCount,
+      uint32_t maxLeafTriangles = DefaultMaxLeafTriangles);
+    void Clear();
+
+    // maxDistance 以内で最も近い交差を求める. 裏面とも交差する.
+    bool RayCast(DirectX::FXMVECTOR origin, DirectX::FXMVECTOR direction, float maxDistance, RayHit& hit) const;
+    // maxDistance 以内で point に最も近い三角形上の点を求める.
+    bool FindClosestPoint(DirectX::FXMVECTOR point, float maxDistance, ClosestPointResult& result) const;
+
+    const std::vector<Node>& GetNodes() const { return m_nodes; }
+    uint32_t GetTriangleCount() const { return uint32_t(m_triangleIds.size()); }
+    size_t GetMemorySize() const;
+
+  private:
+    // 葉の並び順に詰めた三角形の頂点.
+    struct Triangle {
+      DirectX::XMFLOAT3 v0, v1, v2;
+    };
+    std::vector<Node> m_nodes;
+    std::vector<Triangle> m_triangles;
+    std::vector<uint32_t> m_triangleIds;  // m_triangles[i] の元の三角形番号.
+  };
+}
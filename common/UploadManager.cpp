@@ -0,0 +1,174 @@
+#include "UploadManager.h"
+#include "d3dx12.h"
+
+#include <stdexcept>
+#include <cstring>
+
+UploadManager::UploadManager(ComPtr<ID3D12Device> device, UINT64 pageSize)
+  : m_device(device), m_isRecording(false), m_pageSize(pageSize), m_pageOffset(0),
+  m_pendingBytes(0)
+{
+  D3D12_COMMAND_QUEUE_DESC queueDesc{
+    D3D12_COMMAND_LIST_TYPE_COPY,
+    0,
+    D3D12_COMMAND_QUEUE_FLAG_NONE,
+    0
+  };
+  HRESULT hr = m_device->CreateCommandQueue(&queueDesc, IID_PPV_ARGS(&m_queue));
+  ThrowIfFailed(hr, "CreateCommandQueue(Copy) 失敗");
+  m_queue->SetName(L"UploadCopyQueue");
+  m_timeline = std::make_shared<FenceTimeline>(m_device, m_queue);
+}
+
+UploadManager::~UploadManager()
+{
+  Wait(Submit());
+}
+
+void UploadManager::UploadBuffer(ID3D12Resource* dst, UINT64 dstOffset, const void* data, UINT64 size)
+{
+  auto alloc = Allocate(size, 16);
+  memcpy(alloc.cpuAddress, data, size);
+  GetCommandList()->CopyBufferRegion(dst, dstOffset, alloc.resource, alloc.offset, size);
+  m_pendingBytes += size;
+  if (m_pendingBytes > MaxPendingBytes) {
+    Submit();
+  }
+}
+
+void UploadManager::UploadTexture(ID3D12Resource* dst, const D3D12_SUBRESOURCE_DATA* subresources, UINT subresourceCount, UINT firstSubresource)
+{
+  auto size = GetRequiredIntermediateSize(dst, firstSubresource, subresourceCount);
+  auto alloc = Allocate(size, D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT);
+  // ステージングへの書き込みとコピーの記録は d3dx12 のヘルパに任せる.
+  auto written = UpdateSubresources(GetCommandList(), dst, alloc.resource, alloc.offset,
+    firstSubresource, subresourceCount, const_cast<D3D12_SUBRESOURCE_DATA*>(subresources));
+  if (written == 0) {
+    throw std::runtime_error("UploadTexture 失敗.");
+  }
+  m_pendingBytes += size;
+  if (m_pendingBytes > MaxPendingBytes) {
+    Submit();
+  }
+}
+
+UINT64 UploadManager::Submit()
+{
+  if (!m_isRecording) {
+    return m_timeline->GetLastSignaledValue();
+  }
+  m_commandList->Close();
+  ID3D12CommandList* lists[] = { m_commandList.Get() };
+  m_queue->ExecuteCommandLists(1, lists);
+  auto value = m_timeline->Signal();
+
+  m_inFlightAllocators.push_back({ value, m_currentAllocator });
+  m_currentAllocator.Reset();
+  for (auto& page : m_recordingPages) {
+    page->fenceValue = value;
+    m_inFlightPages.emplace_back(std::move(page));
+  }
+  m_recordingPages.clear();
+  m_pageOffset = 0;
+  m_pendingBytes = 0;
+  m_isRecording = false;
+  return value;
+}
+
+void UploadManager::Wait(UINT64 fenceValue)
+{
+  m_timeline->Wait(fenceValue);
+  RetireCompleted();
+}
+
+UploadManager::Allocation UploadManager::Allocate(UINT64 size, UINT64 align)
+{
+  RetireCompleted();
+
+  auto offset = (m_pageOffset + align - 1) & ~(align - 1);
+  if (m_recordingPages.empty() || offset + size > m_recordingPages.back()->size) {
+    std::unique_ptr<Page> page;
+    if (size > m_pageSize) {
+      // 大きな転送は専用のページを作り, 完了後に解放する.
+      page = CreatePage(size);
+    } else if (!m_freePages.empty()) {
+      page = std::move(m_freePages.back());
+      m_freePages.pop_back();
+    } else {
+      page = CreatePage(m_pageSize);
+    }
+    // 書き込み中のページを末尾に保つため, 専用ページは手前に入れる.
+    if (size > m_pageSize && !m_recordingPages.empty()) {
+      m_recordingPages.insert(m_recordingPages.end() - 1, std::move(page));
+      auto* dedicated = (m_recordingPages.end() - 2)->get();
+      return Allocation{ dedicated->resource.Get(), dedicated->mapped, 0 };
+    }
+    m_recordingPages.emplace_back(std::move(page));
+    offset = 0;
+  }
+  auto* page = m_recordingPages.back().get();
+  m_pageOffset = offset + size;
+  return Allocation{ page->resource.Get(), page->mapped + offset, offset };
+}
+
+std::unique_ptr<UploadManager::Page> UploadManager::CreatePage(UINT64 size)
+{
+  auto page = std::make_unique<Page>();
+  auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+  auto desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+  HRESULT hr = m_device->CreateCommittedResource(
+    &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+    D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&page->resource));
+  ThrowIfFailed(hr, "UploadManager のページ作成に失敗.");
+  page->resource->SetName(L"UploadManagerPage");
+
+  CD3DX12_RANGE readRange(0, 0);
+  hr = page->resource->Map(0, &readRange, reinterpret_cast<void**>(&page->mapped));
+  ThrowIfFailed(hr, "UploadManager のページの Map に失敗.");
+  page->size = size;
+  page->fenceValue = 0;
+  return page;
+}
+
+ID3D12GraphicsCommandList* UploadManager::GetCommandList()
+{
+  if (m_isRecording) {
+    return m_commandList.Get();
+  }
+  RetireCompleted();
+  if (!m_freeAllocators.empty()) {
+    m_currentAllocator = m_freeAllocators.back();
+    m_freeAllocators.pop_back();
+    m_currentAllocator->Reset();
+  } else {
+    HRESULT hr = m_device->CreateCommandAllocator(D3D12_COMMAND_LIST_TYPE_COPY, IID_PPV_ARGS(&m_currentAllocator));
+    ThrowIfFailed(hr, "CreateCommandAllocator(Copy) 失敗");
+  }
+
+  if (!m_commandList) {
+    HRESULT hr = m_device->CreateCommandList(0, D3D12_COMMAND_LIST_TYPE_COPY, m_currentAllocator.Get(), nullptr, IID_PPV_ARGS(&m_commandList));
+    ThrowIfFailed(hr, "CreateCommandList(Copy) 失敗");
+    m_commandList->SetName(L"UploadCopyCommand");
+  } else {
+    m_commandList->Reset(m_currentAllocator.Get(), nullptr);
+  }
+  m_isRecording = true;
+  return m_commandList.Get();
+}
+
+void UploadManager::RetireCompleted()
+{
+  auto completed = m_timeline->GetCompletedValue();
+  while (!m_inFlightAllocators.empty() && m_inFlightAllocators.front().fenceValue <= completed) {
+    m_freeAllocators.push_back(m_inFlightAllocators.front().allocator);
+    m_inFlightAllocators.pop_front();
+  }
+  while (!m_inFlightPages.empty() && m_inFlightPages.front()->fenceValue <= completed) {
+    auto page = std::move(m_inFlightPages.front());
+    m_inFlightPages.pop_front();
+    // 専用ページは再利用せずに解放する.
+    if (page->size == m_pageSize) {
+      m_freePages.emplace_back(std::move(page));
+    }
+  }
+}
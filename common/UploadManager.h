@@ -0,0 +1,85 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <deque>
+#include <vector>
+#include <memory>
+
+#include "D3D12BookUtil.h"
+#include "FenceTimeline.h"
+
+// 専用のコピーキューでバッファ/テクスチャの転送をまとめて発行する.
+// 積んだ転送は Submit で 1 回の ExecuteCommandLists にまとめ, コピーキューのタイムラインで完了を追跡する.
+// ステージング用のページはフェンスが進んだら再利用する. メインスレッドから使用すること.
+//
+// コピーキューで触れたリソースは完了後に COMMON へ戻り, グラフィックスキューで使う時に暗黙に昇格する.
+// そのため転送先はバリア無しで頂点/インデックスバッファ, シェーダーリソースとして使える.
+class UploadManager
+{
+public:
+  template<class T>
+  using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+  static const UINT64 DefaultPageSize = 8 * 1024 * 1024;
+  // 未発行の転送がこれを超えたら自動で Submit する.
+  static const UINT64 MaxPendingBytes = 256 * 1024 * 1024;
+
+  UploadManager(ComPtr<ID3D12Device> device, UINT64 pageSize = DefaultPageSize);
+  ~UploadManager();
+
+  void UploadBuffer(ID3D12Resource* dst, UINT64 dstOffset, const void* data, UINT64 size);
+  void UploadTexture(ID3D12Resource* dst, const D3D12_SUBRESOURCE_DATA* subresources, UINT subresourceCount, UINT firstSubresource = 0);
+
+  // 積んだ転送をコピーキューへ発行し, 完了時のフェンス値を返す.
+  // 未発行の転送が無ければ最後に発行したフェンス値を返す.
+  UINT64 Submit();
+
+  // queue に fenceValue までの転送完了を GPU 側で待たせる. CPU はブロックしない.
+  void WaitOnQueue(ID3D12CommandQueue* queue, UINT64 fenceValue) { m_timeline->WaitOnQueue(queue, fenceValue); }
+  // CPU で完了を待つ.
+  void Wait(UINT64 fenceValue);
+  bool IsComplete(UINT64 fenceValue) const { return m_timeline->IsComplete(fenceValue); }
+
+  bool HasPendingUploads() const { return m_isRecording; }
+  UINT64 GetLastSubmittedValue() const { return m_timeline->GetLastSignaledValue(); }
+  ID3D12CommandQueue* GetQueue() const { return m_queue.Get(); }
+  std::shared_ptr<FenceTimeline> GetTimeline() const { return m_timeline; }
+private:
+  struct Page {
+    ComPtr<ID3D12Resource> resource;
+    UINT8* mapped;
+    UINT64 size;
+    UINT64 fenceValue;
+  };
+  struct Allocation {
+    ID3D12Resource* resource;
+    UINT8* cpuAddress;
+    UINT64 offset;
+  };
+  Allocation Allocate(UINT64 size, UINT64 align);
+  std::unique_ptr<Page> CreatePage(UINT64 size);
+  ID3D12GraphicsCommandList* GetCommandList();
+  void RetireCompleted();
+
+  ComPtr<ID3D12Device> m_device;
+  ComPtr<ID3D12CommandQueue> m_queue;
+  ComPtr<ID3D12GraphicsCommandList> m_commandList;
+  ComPtr<ID3D12CommandAllocator> m_currentAllocator;
+  bool m_isRecording;
+
+  struct AllocatorRecord {
+    UINT64 fenceValue;
+    ComPtr<ID3D12CommandAllocator> allocator;
+  };
+  std::deque<AllocatorRecord> m_inFlightAllocators;
+  std::vector<ComPtr<ID3D12CommandAllocator>> m_freeAllocators;
+
+  UINT64 m_pageSize;
+  std::vector<std::unique_ptr<Page>> m_recordingPages;  // 記録中のバッチで使用. 末尾が書き込み中.
+  UINT64 m_pageOffset;
+  std::deque<std::unique_ptr<Page>> m_inFlightPages;
+  std::vector<std::unique_ptr<Page>> m_freePages;
+  UINT64 m_pendingBytes;
+
+  std::shared_ptr<FenceTimeline> m_timeline;
+};
@@ -0,0 +1,94 @@
+#include "UploadRingBuffer.h"
+#include "d3dx12.h"
+
+#include <stdexcept>
+
+UploadRingBuffer::UploadRingBuffer(ComPtr<ID3D12Device> device, std::shared_ptr<FenceTimeline> timeline, UINT64 size)
+  : m_mapped(nullptr), m_gpuAddress(0), m_size(size),
+  m_head(0), m_used(0), m_frameSize(0), m_timeline(timeline)
+{
+  auto heapProps = CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD);
+  auto desc = CD3DX12_RESOURCE_DESC::Buffer(size);
+  HRESULT hr = device->CreateCommittedResource(
+    &heapProps, D3D12_HEAP_FLAG_NONE, &desc,
+    D3D12_RESOURCE_STATE_GENERIC_READ, nullptr, IID_PPV_ARGS(&m_buffer));
+  ThrowIfFailed(hr, "UploadRingBuffer の作成に失敗.");
+  m_buffer->SetName(L"UploadRingBuffer");
+
+  // アップロードヒープは CPU から書き込むだけなので開きっぱなしにしておく.
+  CD3DX12_RANGE readRange(0, 0);
+  hr = m_buffer->Map(0, &readRange, reinterpret_cast<void**>(&m_mapped));
+  ThrowIfFailed(hr, "UploadRingBuffer の Map に失敗.");
+  m_gpuAddress = m_buffer->GetGPUVirtualAddress();
+}
+
+UploadRingBuffer::~UploadRingBuffer()
+{
+  // 使用中のフレームが残っていれば完了を待つ.
+  while (!m_frames.empty()) {
+    WaitOldestFrame();
+  }
+  m_buffer->Unmap(0, nullptr);
+}
+
+UploadRingBuffer::Allocation UploadRingBuffer::Allocate(UINT64 size, UINT64 align)
+{
+  RetireCompletedFrames();
+
+  auto alignedSize = (size + align - 1) & ~(align - 1);
+  if (alignedSize > m_size) {
+    throw std::runtime_error("UploadRingBuffer の容量を超える確保.");
+  }
+
+  for (;;) {
+    // 空になっていれば先頭から使う. 途中の位置のままだと折り返しで捨てる分が余計にかかる.
+    if (m_used == 0) {
+      m_head = 0;
+    }
+    auto offset = (m_head + align - 1) & ~(align - 1);
+    // 末尾に収まらない場合は残りを捨てて先頭から確保する.
+    if (offset + alignedSize > m_size) {
+      offset = 0;
+    }
+    auto consumed = (offset >= m_head ? offset - m_head : m_size - m_head + offset) + alignedSize;
+    if (m_used + consumed <= m_size) {
+      m_head = offset + alignedSize;
+      m_used += consumed;
+      m_frameSize += consumed;
+
+      Allocation alloc;
+      alloc.cpuAddress = m_mapped + offset;
+      alloc.gpuAddress = m_gpuAddress + offset;
+      alloc.offset = offset;
+      return alloc;
+    }
+    if (m_frames.empty()) {
+      // 現在のフレームだけでリングを使い切った.
+      throw std::runtime_error("UploadRingBuffer の容量が不足しています.");
+    }
+    WaitOldestFrame();
+  }
+}
+
+void UploadRingBuffer::FinishFrame()
+{
+  auto value = m_timeline->Signal();
+  m_frames.push_back({ value, m_frameSize });
+  m_frameSize = 0;
+
+  RetireCompletedFrames();
+}
+
+void UploadRingBuffer::RetireCompletedFrames()
+{
+  while (!m_frames.empty() && m_timeline->IsComplete(m_frames.front().fenceValue)) {
+    m_used -= m_frames.front().size;
+    m_frames.pop_front();
+  }
+}
+
+void UploadRingBuffer::WaitOldestFrame()
+{
+  m_timeline->Wait(m_frames.front().fenceValue);
+  RetireCompletedFrames();
+}
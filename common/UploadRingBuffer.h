@@ -0,0 +1,71 @@
+#pragma once
+#include <d3d12.h>
+#include <wrl.h>
+#include <deque>
+#include <memory>
+#include <cstring>
+
+#include "D3D12BookUtil.h"
+#include "FenceTimeline.h"
+
+// 永続的にマップしたアップロードヒープを先頭から順に切り出すリングアロケータ.
+// フレーム毎の定数バッファなどを確保し, GPU がそのフレームを処理し終えたら
+// フェンス値を見てまとめて回収する.
+class UploadRingBuffer
+{
+public:
+  template<class T>
+  using ComPtr = Microsoft::WRL::ComPtr<T>;
+
+  struct Allocation {
+    void* cpuAddress = nullptr;
+    D3D12_GPU_VIRTUAL_ADDRESS gpuAddress = 0;
+    UINT64 offset = 0;
+  };
+
+  // timeline はフレームのコマンドを発行するキューのもの.
+  UploadRingBuffer(ComPtr<ID3D12Device> device, std::shared_ptr<FenceTimeline> timeline, UINT64 size);
+  ~UploadRingBuffer();
+
+  // size バイトを align 境界で確保する. 空きが無い場合は古いフレームの完了を待つ.
+  Allocation Allocate(UINT64 size, UINT64 align = D3D12_CONSTANT_BUFFER_DATA_PLACEMENT_ALIGNMENT);
+
+  // データをコピーして GPU アドレスを返す.
+  D3D12_GPU_VIRTUAL_ADDRESS Upload(const void* data, UINT64 size) {
+    auto alloc = Allocate(size);
+    memcpy(alloc.cpuAddress, data, size);
+    return alloc.gpuAddress;
+  }
+  template<class T>
+  D3D12_GPU_VIRTUAL_ADDRESS Push(const T& data) {
+    return Upload(&data, sizeof(T));
+  }
+
+  // このフレームの確保を締め切り, タイムラインにシグナルを発行する.
+  // ExecuteCommandLists の後に呼び出すこと.
+  void FinishFrame();
+
+  UINT64 GetSize() const { return m_size; }
+  UINT64 GetUsedSize() const { return m_used; }
+  ID3D12Resource* GetResource() const { return m_buffer.Get(); }
+private:
+  void RetireCompletedFrames();
+  void WaitOldestFrame();
+
+  struct FrameRecord {
+    UINT64 fenceValue;
+    UINT64 size;     // このフレームで消費したバイト数 (折り返しで捨てた領域を含む).
+  };
+
+  ComPtr<ID3D12Resource> m_buffer;
+  UINT8* m_mapped;
+  D3D12_GPU_VIRTUAL_ADDRESS m_gpuAddress;
+  UINT64 m_size;
+
+  UINT64 m_head;       // 次に確保する位置.
+  UINT64 m_used;       // 未回収のバイト数.
+  UINT64 m_frameSize;  // 現在のフレームで消費したバイト数.
+
+  std::shared_ptr<FenceTimeline> m_timeline;
+  std::deque<FrameRecord> m_frames;
+};